@@ -176,6 +176,12 @@ ece391_vidmap (uint8_t** screen_start)
     return 0;
 }
 
+void*
+ece391_sbrk (int32_t increment)
+{
+    return sbrk (increment);
+}
+
 int32_t 
 ece391_read (int32_t fd, void* buf, int32_t nbytes)
 {
@@ -51,3 +51,84 @@ ece391_strncmp (const uint8_t* s1, const uint8_t* s2, uint32_t n)
     return ((int32_t)*s1) - ((int32_t)*s2);
 }
 
+/* Heap allocator on top of ece391_sbrk.  Free blocks are kept on a
+ * list sorted by address so neighbours can be merged when freed. */
+
+#define HEAP_ALIGN    8
+#define HEAP_GROW     16384	/* least the heap is grown by at a time */
+
+typedef struct heap_block {
+    uint32_t size;		/* bytes in the block, header included */
+    struct heap_block* next;	/* next free block, only while free */
+} heap_block_t;
+
+static heap_block_t* heap_free_list = 0;
+
+void* ece391_malloc(uint32_t size)
+{
+    heap_block_t** link;
+    heap_block_t* block;
+    uint32_t need, grow;
+
+    if (0 == size || size > 0x7FFFFFFF - sizeof (heap_block_t))
+        return 0;
+    need = (size + sizeof (heap_block_t) + HEAP_ALIGN - 1) & ~(HEAP_ALIGN - 1);
+
+    while (1) {
+        /* first fit, splitting off what isn't needed */
+        for (link = &heap_free_list; 0 != *link; link = &(*link)->next) {
+            block = *link;
+            if (block->size < need)
+                continue;
+            if (block->size - need >= sizeof (heap_block_t) + HEAP_ALIGN) {
+                heap_block_t* rest = (heap_block_t*)((uint8_t*)block + need);
+                rest->size = block->size - need;
+                rest->next = block->next;
+                *link = rest;
+                block->size = need;
+            } else {
+                *link = block->next;
+            }
+            return block + 1;
+        }
+        /* nothing big enough, get more memory from the kernel */
+        grow = need > HEAP_GROW ? need : HEAP_GROW;
+        block = ece391_sbrk (grow);
+        if ((void*)-1 == block)
+            return 0;
+        block->size = grow;
+        ece391_free (block + 1);
+    }
+}
+
+void ece391_free(void* ptr)
+{
+    heap_block_t* block;
+    heap_block_t* prev = 0;
+    heap_block_t* next = heap_free_list;
+
+    if (0 == ptr)
+        return;
+    block = (heap_block_t*)ptr - 1;
+    while (0 != next && next < block) {
+        prev = next;
+        next = next->next;
+    }
+
+    /* merge with the following free block */
+    if (0 != next && (uint8_t*)block + block->size == (uint8_t*)next) {
+        block->size += next->size;
+        block->next = next->next;
+    } else {
+        block->next = next;
+    }
+    /* and with the preceding one */
+    if (0 == prev) {
+        heap_free_list = block;
+    } else if ((uint8_t*)prev + prev->size == (uint8_t*)block) {
+        prev->size += block->size;
+        prev->next = block->next;
+    } else {
+        prev->next = block;
+    }
+}
@@ -19,6 +19,9 @@ extern int32_t ece391_open (const uint8_t* filename);
 extern int32_t ece391_close (int32_t fd);
 extern int32_t ece391_getargs (uint8_t* buf, int32_t nbytes);
 extern int32_t ece391_vidmap (uint8_t** screen_start);
+/* Grows (or, with a negative increment, shrinks) the heap; returns
+ * the old end of the heap, or (void*)-1.  New memory reads as zero. */
+extern void* ece391_sbrk (int32_t increment);
 
 #endif /* ECE391SYSCALL_H */
 
@@ -11,5 +11,9 @@
 #define SYS_VIDMAP  8
 #define SYS_SET_HANDLER  9
 #define SYS_SIGRETURN  10
+#define SYS_SBRK 14
+
+/* the kernel maps its system call stub here in every program */
+#define VSYSCALL_ADDR 0x087FF000
 
 #endif /* ECE391SYSNUM_H */
@@ -1,12 +1,40 @@
 #include "filesystem.h"
 
 #include "lib.h"
+#include "paging.h"
 #include "rtc.h"
 #include "terminal.h"
 
 // filesystem struct to hold pointers to fs sections (boot block, inodes, data blocks)
 filesystem_t filesystem;
 
+// open-addressed name index into the boot block dentries, holds (dentry index + 1) or DENTRY_HASH_EMPTY
+static uint8_t dentry_hash[DENTRY_HASH_SIZE];
+
+// direct-mapped cache of executables that passed exec_file_check, indexed by inode number
+static exec_cache_entry_t exec_cache[EXEC_CACHE_SIZE];
+
+// free block bitmap over the data blocks, a set bit means the block belongs to a file
+static uint32_t block_bitmap[FS_MAX_DATA_BLOCKS / BITS_PER_WORD];
+
+// number of data blocks that fit between the data block array and FS_MEM_END
+static uint32_t data_block_limit;
+
+// per inode results of the mount check
+static inode_info_t inode_info[FS_MAX_INODES];
+
+static void exec_cache_release(exec_cache_entry_t *entry);
+
+// local functions
+static uint32_t hash_filename(const uint8_t *fname);
+static void copy_from_block(uint8_t *dest, const uint8_t *src, uint32_t chunk);
+static int32_t read_data_cursor(file_descriptor_t *file, uint8_t *buf, uint32_t length);
+static void build_dentry_index();
+static void index_dentry(int32_t index);
+static int32_t check_filesys(uint32_t fs_size);
+static void build_block_bitmap();
+static int32_t alloc_data_block();
+
 // default operations
 int32_t default_open(const uint8_t *dirname);
 int32_t default_read(int32_t fd, void *buf, int32_t nbytes);
@@ -43,27 +71,278 @@ const fileops_table_t dirops = {
  * get_filesys
  *  DESCRIPTION: points pointers to the beginning of boot
  *      block, inodes, and data blocks to organize the fs
- *      in a struct and make indexing easier
+ *      in a struct and make indexing easier, then checks
+ *      the image once so reads can trust it afterwards
  *  INPUTS:
  *      fs_addr -- address of fs in memory
+ *      fs_end -- address right after the end of the fs module
  *  OUTPUTS:
  *      filesystem -- struct that holds pointers to each
  *          of the three sections
- *  RETURN VALUE: 0 for success, -1 for failure
- *  SIDE EFFECTS: fills in filesystem struct
+ *  RETURN VALUE: 0 for success, -1 if the image is corrupt
+ *  SIDE EFFECTS: fills in filesystem struct and per inode metadata
  */
-int32_t get_filesys(uint32_t fs_addr) {
+int32_t get_filesys(uint32_t fs_addr, uint32_t fs_end) {
+    int i;
     // make sure pointer is valid
-    if ((void *)fs_addr == NULL) {
+    if ((void *)fs_addr == NULL || fs_end < fs_addr + BLOCK_SIZE) {
         return -1;
     }
     // fill in filesystem struct using pointer passed in
     filesystem.boot_block = (boot_block_t *)((uint8_t *)fs_addr);
     filesystem.inodes = (inode_t *)((uint8_t *)filesystem.boot_block + BLOCK_SIZE);
     filesystem.data_blocks = (data_block_t *)((uint8_t *)filesystem.boot_block + BLOCK_SIZE * (filesystem.boot_block->inode_count + 1));
+    if (check_filesys(fs_end - fs_addr) == -1) {
+        return -1;
+    }
+    // index the file names once so name lookups don't have to scan the boot block
+    build_dentry_index();
+    // find out which data blocks are free for file writes
+    build_block_bitmap();
+    // nothing from a previous image can be trusted
+    for (i = 0; i < EXEC_CACHE_SIZE; i++) {
+        exec_cache[i].inode_num = EXEC_CACHE_EMPTY;
+    }
     return 0;
 }
 
+/*
+ * check_filesys
+ *  DESCRIPTION: consistency check run once at mount. the counts in
+ *      the boot block have to fit in the module, each inode's length
+ *      and used block numbers have to be in range (inodes that fail
+ *      are marked invalid), and every dentry must name an inode that
+ *      exists, a valid one for regular files
+ *  INPUTS:
+ *      fs_size -- size of the fs module in bytes
+ *  OUTPUTS: NONE
+ *  RETURN VALUE: 0 if the image can be used, -1 if it is corrupt
+ *  SIDE EFFECTS: fills in inode_info
+ */
+static int32_t check_filesys(uint32_t fs_size) {
+    boot_block_t *boot_block = filesystem.boot_block;
+    inode_t *file_inode;
+    int32_t num_blocks;
+    int i, j;
+    if (boot_block->dir_count < 1 || boot_block->dir_count > NUM_DIR_ENTRIES || boot_block->inode_count < 1 ||
+        boot_block->inode_count > FS_MAX_INODES || boot_block->data_count < 0 || boot_block->data_count > FS_MAX_DATA_BLOCKS) {
+        return -1;
+    }
+    // boot block, inodes and data blocks all have to be inside the module
+    if ((1 + boot_block->inode_count + boot_block->data_count) > fs_size / BLOCK_SIZE) {
+        return -1;
+    }
+    for (i = 0; i < boot_block->inode_count; i++) {
+        file_inode = &(filesystem.inodes[i]);
+        inode_info[i].valid = 0;
+        inode_info[i].num_blocks = 0;
+        if (file_inode->length < 0 || file_inode->length > NUM_DATA_BLOCKS * BLOCK_SIZE) {
+            continue;
+        }
+        num_blocks = (file_inode->length + BLOCK_SIZE - 1) / BLOCK_SIZE;
+        for (j = 0; j < num_blocks; j++) {
+            if (file_inode->data_block_num[j] < 0 || file_inode->data_block_num[j] >= boot_block->data_count) {
+                break;
+            }
+        }
+        if (j == num_blocks) {
+            inode_info[i].valid = 1;
+            inode_info[i].num_blocks = num_blocks;
+        }
+    }
+    for (i = 0; i < boot_block->dir_count; i++) {
+        if (boot_block->direntries[i].inode_num < 0 || boot_block->direntries[i].inode_num >= boot_block->inode_count) {
+            return -1;
+        }
+        if (boot_block->direntries[i].filetype == REG_FILE_TPYE && !inode_info[boot_block->direntries[i].inode_num].valid) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/*
+ * inode_block_count
+ *  DESCRIPTION: gets the number of data blocks a file uses, as
+ *      worked out at mount (and kept up to date by writes)
+ *  INPUTS:
+ *      inode -- inode number of file
+ *  OUTPUTS: NONE
+ *  RETURN VALUE: number of data blocks, -1 if the inode doesn't
+ *      exist or failed the mount check
+ *  SIDE EFFECTS: NONE
+ */
+int32_t inode_block_count(uint32_t inode) {
+    if (inode >= filesystem.boot_block->inode_count || !inode_info[inode].valid) {
+        return -1;
+    }
+    return inode_info[inode].num_blocks;
+}
+
+/*
+ * hash_filename
+ *  DESCRIPTION: FNV-1a hash over at most FILENAME_LEN bytes
+ *      of a file name, stopping early at a null terminator
+ *      so names compare the same way strncmp sees them
+ *  INPUTS:
+ *      fname -- name of file (not necessarily null terminated)
+ *  OUTPUTS: NONE
+ *  RETURN VALUE: 32-bit hash of the name
+ *  SIDE EFFECTS: NONE
+ */
+static uint32_t hash_filename(const uint8_t *fname) {
+    uint32_t hash = FNV_OFFSET_BASIS;
+    int i;
+    for (i = 0; i < FILENAME_LEN && fname[i] != '\0'; i++) {
+        hash = (hash ^ fname[i]) * FNV_PRIME;
+    }
+    return hash;
+}
+
+/*
+ * build_dentry_index
+ *  DESCRIPTION: fills dentry_hash with every dentry in the
+ *      boot block using linear probing. if two dentries share
+ *      a name, only the first is indexed, matching the order
+ *      a scan of the boot block would find them in
+ *  INPUTS: NONE
+ *  OUTPUTS: NONE
+ *  RETURN VALUE: NONE
+ *  SIDE EFFECTS: overwrites dentry_hash
+ */
+static void build_dentry_index() {
+    int i;
+    memset(dentry_hash, DENTRY_HASH_EMPTY, sizeof(dentry_hash));
+    for (i = 0; i < filesystem.boot_block->dir_count && i < NUM_DIR_ENTRIES; i++) {
+        index_dentry(i);
+    }
+}
+
+/*
+ * index_dentry
+ *  DESCRIPTION: adds one boot block dentry to dentry_hash
+ *      using linear probing, unless its name is already indexed
+ *  INPUTS:
+ *      index -- position of the dentry in the boot block
+ *  OUTPUTS: NONE
+ *  RETURN VALUE: NONE
+ *  SIDE EFFECTS: may fill a slot of dentry_hash
+ */
+static void index_dentry(int32_t index) {
+    uint32_t slot;
+    const dentry_t *dir_entry = &(filesystem.boot_block->direntries[index]);
+    // skip names that are already indexed
+    if (lookup_dentry((uint8_t *)dir_entry->filename) != NULL) {
+        return;
+    }
+    // table is more than twice the max number of dentries, so there is always a free slot
+    slot = hash_filename((uint8_t *)dir_entry->filename) & (DENTRY_HASH_SIZE - 1);
+    while (dentry_hash[slot] != DENTRY_HASH_EMPTY) {
+        slot = (slot + 1) & (DENTRY_HASH_SIZE - 1);
+    }
+    dentry_hash[slot] = index + 1;
+}
+
+/*
+ * build_block_bitmap
+ *  DESCRIPTION: marks every data block used by a regular file in
+ *      block_bitmap, and works out how many data blocks fit in the
+ *      memory after the image for files to grow into
+ *  INPUTS: NONE
+ *  OUTPUTS: NONE
+ *  RETURN VALUE: NONE
+ *  SIDE EFFECTS: overwrites block_bitmap and data_block_limit
+ */
+static void build_block_bitmap() {
+    int i, j;
+    int32_t data_block_idx;
+    const dentry_t *dir_entry;
+    uint32_t data_end = (uint32_t)(filesystem.data_blocks + filesystem.boot_block->data_count);
+    memset(block_bitmap, 0, sizeof(block_bitmap));
+    // the image itself is always usable, anything past it only up to FS_MEM_END
+    data_block_limit = filesystem.boot_block->data_count;
+    if (data_end < FS_MEM_END) {
+        data_block_limit += (FS_MEM_END - data_end) / BLOCK_SIZE;
+    }
+    if (data_block_limit > FS_MAX_DATA_BLOCKS) {
+        data_block_limit = FS_MAX_DATA_BLOCKS;
+    }
+    for (i = 0; i < filesystem.boot_block->dir_count && i < NUM_DIR_ENTRIES; i++) {
+        dir_entry = &(filesystem.boot_block->direntries[i]);
+        // the mount check made sure regular files have valid inodes
+        if (dir_entry->filetype != REG_FILE_TPYE) {
+            continue;
+        }
+        for (j = 0; j < inode_info[dir_entry->inode_num].num_blocks; j++) {
+            data_block_idx = filesystem.inodes[dir_entry->inode_num].data_block_num[j];
+            block_bitmap[data_block_idx / BITS_PER_WORD] |= 1 << (data_block_idx % BITS_PER_WORD);
+        }
+    }
+}
+
+/*
+ * alloc_data_block
+ *  DESCRIPTION: takes the lowest free data block, growing the image's
+ *      data block count when the block lies past its end
+ *  INPUTS: NONE
+ *  OUTPUTS: NONE
+ *  RETURN VALUE: data block number, -1 if the filesystem is full
+ *  SIDE EFFECTS: marks the block used and zeroes it
+ */
+static int32_t alloc_data_block() {
+    int32_t i, bit;
+    for (i = 0; i * BITS_PER_WORD < data_block_limit; i++) {
+        // skip words with every block used
+        if (block_bitmap[i] == 0xFFFFFFFF) {
+            continue;
+        }
+        for (bit = 0; bit < BITS_PER_WORD; bit++) {
+            if (!(block_bitmap[i] & (1 << bit))) {
+                break;
+            }
+        }
+        if (i * BITS_PER_WORD + bit >= data_block_limit) {
+            return -1;
+        }
+        block_bitmap[i] |= 1 << bit;
+        if (i * BITS_PER_WORD + bit >= filesystem.boot_block->data_count) {
+            filesystem.boot_block->data_count = i * BITS_PER_WORD + bit + 1;
+        }
+        memset(filesystem.data_blocks[i * BITS_PER_WORD + bit].data, 0, BLOCK_SIZE);
+        return i * BITS_PER_WORD + bit;
+    }
+    return -1;
+}
+
+/*
+ * lookup_dentry
+ *  DESCRIPTION: finds the dentry for a file name using the
+ *      index built in get_filesys, without copying it
+ *  INPUTS:
+ *      fname -- name of file
+ *  OUTPUTS: NONE
+ *  RETURN VALUE: pointer to the dentry in the boot block,
+ *      NULL if there is no file with that name
+ *  SIDE EFFECTS: NONE
+ */
+const dentry_t *lookup_dentry(const uint8_t *fname) {
+    const dentry_t *dir_entry;
+    uint32_t slot;
+    if (fname == NULL || filesystem.boot_block == NULL) {
+        return NULL;
+    }
+    slot = hash_filename(fname) & (DENTRY_HASH_SIZE - 1);
+    // probe until an empty slot, which ends the chain for this name
+    while (dentry_hash[slot] != DENTRY_HASH_EMPTY) {
+        dir_entry = &(filesystem.boot_block->direntries[dentry_hash[slot] - 1]);
+        if (!strncmp(dir_entry->filename, (int8_t *)fname, FILENAME_LEN)) {
+            return dir_entry;
+        }
+        slot = (slot + 1) & (DENTRY_HASH_SIZE - 1);
+    }
+    return NULL;
+}
+
 /*
  * read_dentry_by_name
  *  DESCRIPTION: uses name of file to find the dentry in boot
@@ -83,20 +362,15 @@ int32_t read_dentry_by_name(const uint8_t *fname, dentry_t *dentry) {
         printf("Invalid parameter to read_dentry_by_name.\n");
         return -1;
     }
-    int i, status;
-    dentry_t dir_entry;
-    // go through dentries in boot block and match file names to locate file
-    for (i = 0; i < filesystem.boot_block->dir_count; i++) {
-        // if read_dentry_by_index call a success fill in passed in dentry
-        status = read_dentry_by_index(i, &dir_entry);
-        if (status == 0 && !strncmp(dir_entry.filename, (int8_t *)fname, FILENAME_LEN)) {
-            *dentry = dir_entry;
-            // return success
-            return 0;
-        }
+    // look the name up in the index and copy out only the matching dentry
+    const dentry_t *dir_entry = lookup_dentry(fname);
+    if (dir_entry == NULL) {
+        // if dentry not found, return failure
+        return -1;
     }
-    // if dentry not found, return failure
-    return -1;
+    *dentry = *dir_entry;
+    // return success
+    return 0;
 }
 
 /*
@@ -139,18 +413,17 @@ int32_t read_dentry_by_index(uint32_t index, dentry_t *dentry) {
  *  SIDE EFFECTS: fills in buffer with data that's read from file
  */
 int32_t read_data(uint32_t inode, uint32_t offset, uint8_t *buf, uint32_t length) {
-    int i, d;                              // for traversing
-    int32_t file_length;                   // store length of file (first 4B in inode)
-    uint32_t extra;                        // to store extra number bytes if length+offset is greater than file_length
-    int data_block_start, data_block_end;  // start and end data blocks we're pulling from
-    int32_t data_start, data_end;          // holds bytes of data to be read in the start and end data block
-    inode_t *temp_inode;                   // temporary inode to hold inode info of file we want to read from
-    int32_t temp_data_idx;                 // temp array to hold data_block_num attribute
-    uint8_t *temp_data;                    // temp data block
-    int32_t bytes_read = 0;                // number of bytes read -> for return value
+    uint32_t file_length;      // store length of file (first 4B in inode)
+    uint32_t block;            // index into the inode's data block list
+    uint32_t block_offset;     // where in the current data block we start copying
+    uint32_t chunk;            // number of bytes copied out of the current data block
+    inode_t *temp_inode;       // inode of file we want to read from
+    int32_t temp_data_idx;     // data block number of the current block
+    uint8_t *temp_data;        // current data block
+    uint32_t bytes_read = 0;   // number of bytes read -> for return value
 
-    // check to make sure inode sent in is within bounds
-    if (inode < 0 || inode >= NUM_DIR_ENTRIES - 1) {
+    // check to make sure inode sent in is within bounds and passed the mount check
+    if (buf == NULL || inode >= filesystem.boot_block->inode_count || !inode_info[inode].valid) {
         return -1;
     }
 
@@ -158,96 +431,226 @@ int32_t read_data(uint32_t inode, uint32_t offset, uint8_t *buf, uint32_t length
     temp_inode = &(filesystem.inodes[inode]);
     file_length = temp_inode->length;
 
-    // if offset is greater than file length then EOF reached, return 0
-    if (offset > file_length) {
+    // if offset is at or past the file length then EOF reached, return 0
+    if (offset >= file_length) {
         return 0;
     }
+    // clamp the read so it stops at the end of the file
+    if (length > file_length - offset) {
+        length = file_length - offset;
+    }
 
     // /4096 since each data block holds 4096B of file
-    data_block_start = offset / BLOCK_SIZE;
-    // subtract from BLOCK_SIZE since we want what's after offset
-    data_start = offset % BLOCK_SIZE;
-
-    // if length + offset is greater than file_length, need to adjust number of bytes we read
-    if ((length + offset) > file_length) {
-        extra = (length + offset) - file_length;
-        // int division gives block number
-        data_block_end = file_length / BLOCK_SIZE;
-        // % by block size gives where in block
-        data_end = file_length % BLOCK_SIZE;
-    } else {
-        data_block_end = (length + offset) / BLOCK_SIZE;
-        // do not subtract from BLOCK_SIZE since we want what's leftover
-        // at the beginning of the data block
-        data_end = (length + offset) % BLOCK_SIZE;
-    }
-
-    // for loop from first data block to last data block
-    for (d = data_block_start; d <= data_block_end; d++) {
-        // get data block num
-        temp_data_idx = temp_inode->data_block_num[d];
-        // make sure it's in bounds or return -1
-        if (temp_data_idx < 0 || temp_data_idx >= filesystem.boot_block->data_count)
-            return -1;
+    block = offset / BLOCK_SIZE;
+    block_offset = offset % BLOCK_SIZE;
 
-        // store data block in a temporary var to access
-        temp_data = (uint8_t *)&(filesystem.data_blocks[temp_data_idx]);
-
-        // for only first data block -- specfic number of bytes
-        if (d == data_block_start) {
-            // make sure we are in bounds of the whole file length and of the data block
-            for (i = 0; bytes_read < length && i + data_start < BLOCK_SIZE; i++) {
-                // if data_block_start and data_block_end are the same
-                if (d == data_block_end && i + data_start >= data_end) {
-                    break;
-                }
-                buf[i] = temp_data[i + data_start];
-                bytes_read++;
-            }
-            // go to next data block
-            continue;
-        }
-        // any data block between start and end -- read all bytes in block
-        if ((d > data_block_start) && (d < data_block_end)) {
-            // make sure we are in bounds of the whole file length and of the data block
-            for (i = 0; bytes_read < length && i < BLOCK_SIZE; i++) {
-                // since bytes_read increments each iteration, use it to index buf
-                buf[bytes_read] = temp_data[i];
-                bytes_read++;
-            }
-            // go to next data block
-            continue;
+    // copy the file a block (or part of a block) at a time
+    while (bytes_read < length) {
+        // block numbers of valid inodes were checked at mount
+        temp_data_idx = temp_inode->data_block_num[block];
+        temp_data = filesystem.data_blocks[temp_data_idx].data;
+
+        // copy up to the end of this block or the end of the read, whichever is first
+        chunk = min(BLOCK_SIZE - block_offset, length - bytes_read);
+        copy_from_block(buf + bytes_read, temp_data + block_offset, chunk);
+        bytes_read += chunk;
+        // every block after the first is read from its beginning
+        block++;
+        block_offset = 0;
+    }
+    // return number of bytes read
+    return bytes_read;
+}
+
+/*
+ * read_data_cursor
+ *  DESCRIPTION: reads from an open file at its file position, like
+ *      read_data, but starts from the data block the fd's cursor
+ *      points at instead of working it out from the position again.
+ *      the cursor is left on the block the read stopped in
+ *  INPUTS:
+ *      file -- open file descriptor to read from
+ *      length -- number of bytes to read
+ *  OUTPUTS:
+ *      buf -- buffer to put read bytes into
+ *  RETURN VALUE: number of bytes read, 0 at end of file, -1 for failure
+ *  SIDE EFFECTS: advances file_pos and the block cursor
+ */
+static int32_t read_data_cursor(file_descriptor_t *file, uint8_t *buf, uint32_t length) {
+    inode_t *file_inode = &(filesystem.inodes[file->inode]);
+    int32_t data_block_idx;
+    uint32_t chunk;
+    uint32_t bytes_read = 0;
+
+    // nothing left past the end of the file
+    if (file->file_pos >= file_inode->length) {
+        return 0;
+    }
+    if (length > file_inode->length - file->file_pos) {
+        length = file_inode->length - file->file_pos;
+    }
+    while (bytes_read < length) {
+        // look up the next block only once the last one is used up
+        if (file->block_ptr == NULL) {
+            data_block_idx = file_inode->data_block_num[file->block_idx];
+            file->block_ptr = filesystem.data_blocks[data_block_idx].data;
         }
-        // last data block -- specific number of bytes
-        if (d == data_block_end) {
-            // make sure we are in bounds of the whole file length and of the data block
-            for (i = 0; bytes_read < length && i < data_end; i++) {
-                // since bytes_read increments each iteration, use it to index buf
-                buf[bytes_read] = temp_data[i];
-                bytes_read++;
-            }
-            // go to next data block
-            continue;
+        chunk = min(BLOCK_SIZE - file->block_offset, length - bytes_read);
+        copy_from_block(buf + bytes_read, file->block_ptr + file->block_offset, chunk);
+        bytes_read += chunk;
+        file->file_pos += chunk;
+        file->block_offset += chunk;
+        // move the cursor to the start of the next block
+        if (file->block_offset == BLOCK_SIZE) {
+            file->block_ptr = NULL;
+            file->block_idx++;
+            file->block_offset = 0;
         }
     }
-    // return number of bytes read
     return bytes_read;
 }
 
+/*
+ * copy_from_block
+ *  DESCRIPTION: copies part of a data block, a whole block going to
+ *      an aligned buffer is copied a dword at a time
+ *  INPUTS:
+ *      src -- where in the data block to copy from
+ *      chunk -- number of bytes, at most BLOCK_SIZE
+ *  OUTPUTS:
+ *      dest -- buffer to copy into
+ *  RETURN VALUE: NONE
+ *  SIDE EFFECTS: NONE
+ */
+static void copy_from_block(uint8_t *dest, const uint8_t *src, uint32_t chunk) {
+    if (chunk == BLOCK_SIZE && ((uint32_t)dest & DWORD_ALIGN_MASK) == 0) {
+        // fast path: whole block into an aligned buffer, straight rep movsl
+        memcpy_dword(dest, src, BLOCK_SIZE / BYTES_PER_DWORD);
+    } else {
+        memcpy(dest, src, chunk);
+    }
+}
+
 /*
  * write_data
- *  DESCRIPTION: does nothing since fs is read-only.
+ *  DESCRIPTION: writes into the in-memory copy of the filesystem.
+ *      only the data blocks the write covers are touched, blocks
+ *      past the end of the file are allocated as needed
  *  INPUTS:
  *      inode -- inode number of file
- *      offset -- offset of write
- *      buf -- to put written bytes into
- *      length -- number bytes written
+ *      offset -- offset of write, at most the file length
+ *      buf -- bytes to write
+ *      length -- number bytes to write
  *  OUTPUTS: NONE
- *  RETURN VALUE: -1 for failure
- *  SIDE EFFECTS: nothing
+ *  RETURN VALUE: number of bytes written (short if the filesystem
+ *      fills up), -1 for failure or if a running process was loaded
+ *      from the file
+ *  SIDE EFFECTS: may grow the file and drop it from the exec cache
  */
-int32_t write_data(uint32_t inode, uint32_t offset, uint8_t *buf, uint32_t length) {
-    return -1;
+int32_t write_data(uint32_t inode, uint32_t offset, const uint8_t *buf, uint32_t length) {
+    inode_t *file_inode;       // inode of the file being written
+    uint32_t block;            // index into the inode's data block list
+    uint32_t block_offset;     // where in the current data block we start copying
+    uint32_t num_blocks;       // number of data blocks the file already has
+    uint32_t chunk;            // number of bytes copied into the current data block
+    int32_t data_block_idx;    // data block number of the current block
+    uint32_t bytes_written = 0;
+
+    if (buf == NULL || inode >= filesystem.boot_block->inode_count || !inode_info[inode].valid) {
+        return -1;
+    }
+    // a running program still fills its pages from the file, it would end up part old and part new
+    if (exec_inode_in_use(inode)) {
+        return -1;
+    }
+    file_inode = &(filesystem.inodes[inode]);
+    // files can't have holes, and can't outgrow the inode's block list
+    if (offset > file_inode->length || length > NUM_DATA_BLOCKS * BLOCK_SIZE - offset) {
+        return -1;
+    }
+    num_blocks = inode_info[inode].num_blocks;
+    block = offset / BLOCK_SIZE;
+    block_offset = offset % BLOCK_SIZE;
+    while (bytes_written < length) {
+        // blocks past the end of the file are allocated as the write reaches them
+        if (block >= num_blocks) {
+            data_block_idx = alloc_data_block();
+            if (data_block_idx == -1) {
+                break;
+            }
+            file_inode->data_block_num[block] = data_block_idx;
+            inode_info[inode].num_blocks = ++num_blocks;
+        } else {
+            data_block_idx = file_inode->data_block_num[block];
+        }
+        chunk = min(BLOCK_SIZE - block_offset, length - bytes_written);
+        memcpy(filesystem.data_blocks[data_block_idx].data + block_offset, buf + bytes_written, chunk);
+        bytes_written += chunk;
+        block++;
+        block_offset = 0;
+    }
+    if (offset + bytes_written > file_inode->length) {
+        file_inode->length = offset + bytes_written;
+    }
+    // an executable that was written to has to be checked again
+    exec_cache_invalidate(inode);
+    // out of space before anything could be written
+    if (bytes_written == 0 && length != 0) {
+        return -1;
+    }
+    return bytes_written;
+}
+
+/*
+ * create_file
+ *  DESCRIPTION: adds an empty regular file to the directory,
+ *      using the first inode no dentry refers to
+ *  INPUTS:
+ *      fname -- name of the new file
+ *      length -- number of bytes in the name (at most FILENAME_LEN)
+ *  OUTPUTS: NONE
+ *  RETURN VALUE: 0 for success, -1 if the name is bad or taken,
+ *      or the directory or inodes are full
+ *  SIDE EFFECTS: adds a dentry to the boot block and the name index
+ */
+int32_t create_file(const uint8_t *fname, uint32_t length) {
+    uint8_t filename[FILENAME_LEN + 1];
+    dentry_t *dir_entry;
+    int32_t inode, i;
+    if (fname == NULL || length == 0 || length > FILENAME_LEN || filesystem.boot_block->dir_count >= NUM_DIR_ENTRIES) {
+        return -1;
+    }
+    memset(filename, 0, sizeof(filename));
+    memcpy(filename, fname, length);
+    if (strlen((int8_t *)filename) != length || lookup_dentry(filename) != NULL) {
+        return -1;
+    }
+    // inode 0 belongs to the directory and rtc, look for one no regular file uses
+    for (inode = 1; inode < filesystem.boot_block->inode_count; inode++) {
+        for (i = 0; i < filesystem.boot_block->dir_count; i++) {
+            if (filesystem.boot_block->direntries[i].filetype == REG_FILE_TPYE && filesystem.boot_block->direntries[i].inode_num == inode) {
+                break;
+            }
+        }
+        if (i == filesystem.boot_block->dir_count) {
+            break;
+        }
+    }
+    if (inode == filesystem.boot_block->inode_count) {
+        return -1;
+    }
+    filesystem.inodes[inode].length = 0;
+    inode_info[inode].num_blocks = 0;
+    inode_info[inode].valid = 1;
+    exec_cache_invalidate(inode);
+    dir_entry = &(filesystem.boot_block->direntries[filesystem.boot_block->dir_count]);
+    memset(dir_entry, 0, sizeof(dentry_t));
+    memcpy(dir_entry->filename, filename, length);
+    dir_entry->filetype = REG_FILE_TPYE;
+    dir_entry->inode_num = inode;
+    index_dentry(filesystem.boot_block->dir_count);
+    filesystem.boot_block->dir_count++;
+    return 0;
 }
 
 int32_t start_process(file_descriptor_t *PCB) {
@@ -306,6 +709,10 @@ int32_t file_open(const uint8_t *filename) {
                 curr_pcb->file_desc[fd].fileops_table_ptr = (int32_t *)(&fileops);
                 curr_pcb->file_desc[fd].file_pos = 0;
                 curr_pcb->file_desc[fd].flags = 1;
+                // cursor starts at the beginning of the first block
+                curr_pcb->file_desc[fd].block_ptr = NULL;
+                curr_pcb->file_desc[fd].block_idx = 0;
+                curr_pcb->file_desc[fd].block_offset = 0;
                 // return fd just made
                 return fd;
             }
@@ -338,29 +745,40 @@ int32_t file_read(int32_t fd, void *buf, int32_t nbytes) {
     if ((fd < 0 || fd >= FD_SIZE) || buf == NULL || !curr_pcb->file_desc[fd].flags) {
         return -1;
     }
-    // read data from open file and place in buffer
-    int num_bytes_read = read_data(curr_pcb->file_desc[fd].inode, curr_pcb->file_desc[fd].file_pos, (uint8_t *)buf, nbytes);
-    // if we read more than 0 bytes update file position
-    if (num_bytes_read > 0) {
-        curr_pcb->file_desc[fd].file_pos += num_bytes_read;
+    if (nbytes < 0) {
+        return -1;
     }
-    // will only reach here on success
-    return num_bytes_read;
+    // read data from open file and place in buffer, continuing from the fd's block cursor
+    return read_data_cursor(&(curr_pcb->file_desc[fd]), (uint8_t *)buf, nbytes);
 }
 
 /*
  * file_write
- *  DESCRIPTION: does nothing since fs is read-only.
+ *  DESCRIPTION: writes to an open file at its file position,
+ *      growing the file if the write goes past its end
  *  INPUTS:
- *      fd -- file descriptor for directory
- *      buf -- to put written bytes into
- *      nbytes -- number bytes written
+ *      fd -- file descriptor for file
+ *      buf -- bytes to write
+ *      nbytes -- number bytes to write
  *  OUTPUTS: NONE
- *  RETURN VALUE: -1 for failure
- *  SIDE EFFECTS: nothing
+ *  RETURN VALUE: number of bytes written, -1 for failure or if the
+ *      file is the program of a running process
+ *  SIDE EFFECTS: updates file position and moves the block cursor there
  */
 int32_t file_write(int32_t fd, const void *buf, int32_t nbytes) {
-    return -1;
+    // make sure all paramaters are valid, bounds check
+    if ((fd < 0 || fd >= FD_SIZE) || buf == NULL || nbytes < 0 || !curr_pcb->file_desc[fd].flags) {
+        return -1;
+    }
+    file_descriptor_t *file = &(curr_pcb->file_desc[fd]);
+    int32_t num_bytes_written = write_data(file->inode, file->file_pos, (const uint8_t *)buf, nbytes);
+    if (num_bytes_written > 0) {
+        file->file_pos += num_bytes_written;
+        file->block_ptr = NULL;
+        file->block_idx = file->file_pos / BLOCK_SIZE;
+        file->block_offset = file->file_pos % BLOCK_SIZE;
+    }
+    return num_bytes_written;
 }
 
 /*
@@ -472,6 +890,40 @@ int32_t dir_read(int32_t fd, void *buf, int32_t nbytes) {
     }
 }
 
+/*
+ * dir_getdents
+ *  DESCRIPTION: reads as many directory records as fit in the
+ *      buffer, starting at the fd's position, straight out of the
+ *      boot block
+ *  INPUTS:
+ *      fd -- file descriptor for directory
+ *      nbytes -- size of buf, at least one dirent_t
+ *  OUTPUTS:
+ *      buf -- packed dirent_t records
+ *  RETURN VALUE: number of bytes filled in (a multiple of the record
+ *      size), 0 once every entry has been read, -1 for failure
+ *  SIDE EFFECTS: advances the fd's position past the records read
+ */
+int32_t dir_getdents(int32_t fd, void *buf, int32_t nbytes) {
+    dirent_t *record = (dirent_t *)buf;
+    const dentry_t *dir_entry;
+    int32_t count = 0;
+    if ((fd < 0 || fd >= FD_SIZE) || buf == NULL || nbytes < (int32_t)sizeof(dirent_t) || !curr_pcb->file_desc[fd].flags) {
+        return -1;
+    }
+    while ((count + 1) * sizeof(dirent_t) <= nbytes && curr_pcb->file_desc[fd].file_pos < filesystem.boot_block->dir_count) {
+        dir_entry = &(filesystem.boot_block->direntries[curr_pcb->file_desc[fd].file_pos]);
+        memcpy(record[count].filename, dir_entry->filename, FILENAME_LEN);
+        record[count].filetype = dir_entry->filetype;
+        record[count].inode_num = dir_entry->inode_num;
+        // only regular files have a length, the mount check made sure their inodes exist
+        record[count].size = dir_entry->filetype == REG_FILE_TPYE ? filesystem.inodes[dir_entry->inode_num].length : 0;
+        curr_pcb->file_desc[fd].file_pos++;
+        count++;
+    }
+    return count * sizeof(dirent_t);
+}
+
 /*
  * dir_close
  *  DESCRIPTION: closes directory fd in PCB by setting fd
@@ -500,17 +952,24 @@ int32_t dir_close(int32_t fd) {
 
 /*
  * dir_write
- *  DESCRIPTION: does nothing since fs is read-only.
+ *  DESCRIPTION: creates an empty regular file named by the bytes
+ *      written, since a flat directory holds nothing but names
  *  INPUTS:
  *      fd -- file descriptor for directory
- *      buf -- to put written bytes into
- *      nbytes -- number bytes written
+ *      buf -- name of the new file
+ *      nbytes -- length of the name
  *  OUTPUTS: NONE
- *  RETURN VALUE: -1 for failure
- *  SIDE EFFECTS: nothing
+ *  RETURN VALUE: nbytes for success, -1 for failure
+ *  SIDE EFFECTS: adds a file to the filesystem
  */
 int32_t dir_write(int32_t fd, const void *buf, int32_t nbytes) {
-    return -1;
+    if ((fd < 0 || fd >= FD_SIZE) || buf == NULL || nbytes <= 0 || !curr_pcb->file_desc[fd].flags) {
+        return -1;
+    }
+    if (create_file((const uint8_t *)buf, nbytes) == -1) {
+        return -1;
+    }
+    return nbytes;
 }
 
 /*
@@ -562,9 +1021,26 @@ int32_t default_close(int32_t fd) {
 }
 
 uint8_t ELF_MAGIC[ELF_MAGIC_LEN] = {0x7F, 0x45, 0x4C, 0x46};
+
+/*
+ * exec_file_check
+ *  DESCRIPTION: finds the executable named by the first word of a
+ *      command and gets its entry point. executables seen before are
+ *      answered from the exec cache, others have their ELF magic and
+ *      entry point read from the file and are added to the cache
+ *  INPUTS:
+ *      command -- command from the execute syscall
+ *  OUTPUTS:
+ *      prog_eip -- entry point of the program
+ *      dir_entry -- dentry of the program
+ *  RETURN VALUE: 0 for success, -1 if the file is missing or not executable
+ *  SIDE EFFECTS: may fill in an exec cache entry
+ */
 int32_t exec_file_check(const uint8_t * command, uint32_t * prog_eip, dentry_t * dir_entry) {
-    uint8_t filename[FILENAME_LEN];
+    uint8_t filename[FILENAME_LEN + 1];
     uint8_t elf_magic[ELF_MAGIC_LEN];
+    const dentry_t *file_dentry;
+    exec_cache_entry_t *entry;
     int i, status;
     /* check for garbage input values */
     if (command == NULL || prog_eip == NULL || dir_entry == NULL) {
@@ -575,21 +1051,88 @@ int32_t exec_file_check(const uint8_t * command, uint32_t * prog_eip, dentry_t *
         filename[i] = command[i];
     }
     filename[i] = '\0';
-    /* get the directory entry of the file */
-    status = read_dentry_by_name(filename, dir_entry);
-    if (status == -1) {
+    /* get the directory entry of the file, only regular files can be executed */
+    file_dentry = lookup_dentry(filename);
+    if (file_dentry == NULL || file_dentry->filetype != REG_FILE_TPYE) {
         return -1;
     }
+    *dir_entry = *file_dentry;
+    /* programs that have been checked before skip straight to their entry point */
+    entry = exec_cache_lookup(dir_entry->inode_num);
+    if (entry != NULL) {
+        *prog_eip = entry->prog_eip;
+        return 0;
+    }
     /* read the beginning ELF_MAGIC_LEN bytes to verify 0x7F 0x45 0x4C 0x46 is seen at the beginning of the executable */
     status = read_data(dir_entry->inode_num, 0, elf_magic, ELF_MAGIC_LEN);
-    if (status == -1 || strncmp((int8_t *)elf_magic, (int8_t *)ELF_MAGIC, ELF_MAGIC_LEN)) {
+    if (status != ELF_MAGIC_LEN || strncmp((int8_t *)elf_magic, (int8_t *)ELF_MAGIC, ELF_MAGIC_LEN)) {
         return -1;
     }
     /* get prog_eip from bytes 24-27 */
     status = read_data(dir_entry->inode_num, PROG_EIP_START_BYTE, (uint8_t *)(prog_eip), 4);
-    if (status == -1) {
+    if (status != 4) {
         return -1;
     }
-    /* since ELF magic seen, the file is executable and passes */
+    /* since ELF magic seen, the file is executable, remember it for next time */
+    entry = &exec_cache[dir_entry->inode_num & (EXEC_CACHE_SIZE - 1)];
+    exec_cache_release(entry);
+    entry->inode_num = dir_entry->inode_num;
+    entry->prog_eip = *prog_eip;
     return 0;
 }
+
+/*
+ * exec_cache_lookup
+ *  DESCRIPTION: finds the exec cache entry for an executable
+ *  INPUTS:
+ *      inode -- inode number of the executable
+ *  OUTPUTS: NONE
+ *  RETURN VALUE: the cache entry, NULL if the executable isn't cached
+ *  SIDE EFFECTS: NONE
+ */
+exec_cache_entry_t *exec_cache_lookup(uint32_t inode) {
+    exec_cache_entry_t *entry = &exec_cache[inode & (EXEC_CACHE_SIZE - 1)];
+    if (entry->inode_num != inode) {
+        return NULL;
+    }
+    return entry;
+}
+
+/*
+ * exec_cache_invalidate
+ *  DESCRIPTION: forgets an executable, so the next execute of it
+ *      checks the file again (call whenever the file changes)
+ *  INPUTS:
+ *      inode -- inode number of the file
+ *  OUTPUTS: NONE
+ *  RETURN VALUE: NONE
+ *  SIDE EFFECTS: may empty an exec cache entry
+ */
+void exec_cache_invalidate(uint32_t inode) {
+    exec_cache_entry_t *entry = exec_cache_lookup(inode);
+    if (entry != NULL) {
+        exec_cache_release(entry);
+    }
+}
+
+/*
+ * exec_cache_release
+ *  DESCRIPTION: empties an exec cache entry, dropping the cache's
+ *      reference to each shared image page. processes still running
+ *      the executable keep the pages they have mapped
+ *  INPUTS:
+ *      entry -- the entry to empty
+ *  OUTPUTS: NONE
+ *  RETURN VALUE: NONE
+ *  SIDE EFFECTS: may return frames to the frame pool
+ */
+static void exec_cache_release(exec_cache_entry_t *entry) {
+    int i;
+    for (i = 0; i < EXEC_CACHE_PAGES; i++) {
+        if (entry->frames[i] != 0) {
+            put_frame(entry->frames[i]);
+            entry->frames[i] = 0;
+        }
+    }
+    entry->inode_num = EXEC_CACHE_EMPTY;
+}
@@ -19,6 +19,17 @@
 #define STDOUT_PCB_IDX 1            // index of stdout (terminal output) file in PCB
 #define ELF_MAGIC_LEN 4             // length of ".ELF" magic at beginning of executable files
 #define PROG_EIP_START_BYTE 24      // offset into executables at which the prog_eip address is found
+#define DENTRY_HASH_SIZE 128        // slots in the dentry name index (power of 2, more than twice NUM_DIR_ENTRIES)
+#define DENTRY_HASH_EMPTY 0         // marks an unused slot in the dentry name index
+#define FNV_OFFSET_BASIS 2166136261U // starting value for the FNV-1a filename hash
+#define FNV_PRIME 16777619U         // multiplier for the FNV-1a filename hash
+#define EXEC_CACHE_SIZE 16          // number of validated executables remembered (power of 2)
+#define EXEC_CACHE_EMPTY -1         // inode number of an unused exec cache entry
+#define EXEC_CACHE_PAGES 16         // image pages per executable shared between processes
+#define FS_MAX_DATA_BLOCKS 1024     // data blocks tracked by the free block bitmap
+#define FS_MAX_INODES 1024          // inodes the mount check keeps metadata for
+#define BITS_PER_WORD 32            // data blocks per word of the free block bitmap
+#define FS_MEM_END (KP_BOTTOM - KS_SIZE)            // new data blocks can use memory past the image up to the boot stack
 
 extern uint8_t ELF_MAGIC[ELF_MAGIC_LEN]; // magic expected at beginning of executable files
 extern uint32_t pid_count;
@@ -90,6 +101,43 @@ typedef struct filesystem {
 //     int32_t flags;
 // } file_descriptor_t;
 
+/*
+ * one directory record handed out by the getdents syscall
+ *  -filename (32B, not null terminated if the name is 32 chars)
+ *  -filetype (4B)
+ *  -inode_num (4B)
+ *  -size (length of a regular file in bytes, 0 otherwise)
+ */
+typedef struct dirent {
+    int8_t filename[FILENAME_LEN];
+    int32_t filetype;
+    int32_t inode_num;
+    int32_t size;
+} dirent_t;
+
+/*
+ * what the mount check worked out about each inode
+ *  -num_blocks (data blocks in use, from the length)
+ *  -valid (1 if the length and every used block number are in range)
+ */
+typedef struct inode_info {
+    uint16_t num_blocks;
+    uint16_t valid;
+} inode_info_t;
+
+/*
+ * an executable that already passed exec_file_check
+ *  -inode_num (tag, EXEC_CACHE_EMPTY if unused)
+ *  -prog_eip (entry point read from bytes 24-27)
+ *  -frames (read only copies of the first image pages shared by every
+ *   process running the executable, 0 until a process touches the page)
+ */
+typedef struct exec_cache_entry {
+    int32_t inode_num;
+    uint32_t prog_eip;
+    uint32_t frames[EXEC_CACHE_PAGES];
+} exec_cache_entry_t;
+
 // all the file operations (file and directory)
 typedef int32_t (*open_t)(const uint8_t *);
 typedef int32_t (*read_t)(int32_t, void *, int32_t);
@@ -108,11 +156,16 @@ typedef struct fileops_table {
 
 /* CHECK FILESYSTEM.C FOR FUNCTION INTERFACES */
 extern filesystem_t filesystem;
-int32_t get_filesys(uint32_t fs_addr);
+extern const fileops_table_t fileops;
+extern const fileops_table_t dirops;
+int32_t get_filesys(uint32_t fs_addr, uint32_t fs_end);
+int32_t inode_block_count(uint32_t inode);
+const dentry_t * lookup_dentry(const uint8_t * fname);
 int32_t read_dentry_by_name(const uint8_t * fname, dentry_t * dentry);
 int32_t read_dentry_by_index(uint32_t index, dentry_t * dentry);
 int32_t read_data(uint32_t inode, uint32_t offset, uint8_t * buf, uint32_t length);
-int32_t write_data(uint32_t inode, uint32_t offset, uint8_t * buf, uint32_t length);
+int32_t write_data(uint32_t inode, uint32_t offset, const uint8_t * buf, uint32_t length);
+int32_t create_file(const uint8_t * fname, uint32_t length);
 
 extern file_descriptor_t TEST_PCB[FD_SIZE];
 int32_t start_process(file_descriptor_t * PCB);
@@ -126,7 +179,10 @@ int32_t dir_open(const uint8_t * dirname);
 int32_t dir_read(int32_t fd, void * buf, int32_t nbytes);
 int32_t dir_write(int32_t fd, const void * buf, int32_t nbytes);
 int32_t dir_close(int32_t fd);
+int32_t dir_getdents(int32_t fd, void * buf, int32_t nbytes);
 
 int32_t exec_file_check(const uint8_t * command, uint32_t * prog_eip, dentry_t * dir_entry);
+exec_cache_entry_t * exec_cache_lookup(uint32_t inode);
+void exec_cache_invalidate(uint32_t inode);
 
 #endif
@@ -5,6 +5,7 @@
 #include "lib.h"
 #include "x86_desc.h"
 #include "syscall.h"
+#include "paging.h"
 
 // local functions (handlers)
 void divide_error_exception_handler();
@@ -21,7 +22,7 @@ void invalid_tss_exception_handler();
 void segment_not_present_handler();
 void stack_fault_exception_handler();
 void general_protection_exception_handler();
-void page_fault_exception_handler();
+void page_fault_exception_handler(uint32_t error_code, uint32_t fault_addr);
 void x87_FPU_floating_point_error_handler();
 void alignment_check_exception_handler();
 void machine_check_exception_handler();
@@ -69,7 +70,7 @@ void init_IDT() {
     SET_IDT_ENTRY(idt[11], &segment_not_present_handler);
     SET_IDT_ENTRY(idt[12], &stack_fault_exception_handler);
     SET_IDT_ENTRY(idt[13], &general_protection_exception_handler);
-    SET_IDT_ENTRY(idt[14], &page_fault_exception_handler);
+    SET_IDT_ENTRY(idt[14], &page_fault_linkage);
     // putting a general interrupt for reserved entry 15
     SET_IDT_ENTRY(idt[15], &general_exception_handler);
     SET_IDT_ENTRY(idt[16], &x87_FPU_floating_point_error_handler);
@@ -198,7 +199,21 @@ void general_protection_exception_handler() {
     halt(-1);
 }
 
-void page_fault_exception_handler() {
+/*
+ * page_fault_exception_handler
+ *   DESCRIPTION: handler for page faults, called from page_fault_linkage
+ *                faults on user program pages that haven't been loaded yet
+ *                are filled in and return to retry the instruction
+ *   INPUTS: error_code -- error code pushed by the processor
+ *           fault_addr -- faulting virtual address (cr2)
+ *   OUTPUTS: none
+ *   RETURN VALUE: none
+ *   SIDE EFFECTS: halts the program if the fault can't be handled
+ */
+void page_fault_exception_handler(uint32_t error_code, uint32_t fault_addr) {
+    if (handle_page_fault(error_code, fault_addr) == 0) {
+        return;
+    }
     cli();
     printf("Page Fault Exception\n");
     sti();
@@ -6,5 +6,6 @@ extern void keyboard_interrupt_handler();
 extern void rtc_interrupt_handler();
 extern int system_call_handler();
 extern void timer_handler();
+extern void page_fault_linkage();
 
 #endif
@@ -24,6 +24,10 @@
 /* Check if the bit BIT in FLAGS is set. */
 #define CHECK_FLAG(flags, bit) ((flags) & (1 << (bit)))
 
+/* mem_upper counts KB of RAM starting at 1 MB */
+#define MEM_UPPER_START_KB 1024
+#define KB_SIZE 1024
+
 /* Check if MAGIC is valid and print the Multiboot information structure
    pointed by ADDR. */
 void entry(unsigned long magic, unsigned long addr) {
@@ -160,10 +164,20 @@ void entry(unsigned long magic, unsigned long addr) {
      */
     pcb_arr_init();
     init_terminals();
-    get_filesys(((module_t *)mbi->mods_addr)->mod_start);
+    if (get_filesys(((module_t *)mbi->mods_addr)->mod_start, ((module_t *)mbi->mods_addr)->mod_end) == -1) {
+        printf("Filesystem image is corrupt, not booting\n");
+        return;
+    }
 
-    /* Init and enable paging */
-    paging_init();
+    /* Init and enable paging, the frame pool runs to the end of RAM */
+    if (CHECK_FLAG(mbi->flags, 0)) {
+        paging_init((mbi->mem_upper + MEM_UPPER_START_KB) * KB_SIZE);
+    } else {
+        paging_init(DEFAULT_MEM_END);
+    }
+
+    // system call stub page and SYSENTER
+    syscall_init();
 
     // enable RTC
     init_rtc();
@@ -181,8 +195,13 @@ void entry(unsigned long magic, unsigned long addr) {
     // printf("Enabling Interrupts\n");
     sti();
 
+#ifdef BENCH
+    /* execute doesn't return, so the benchmarks go first; they clear the screen and leave their results above the shell */
+    launch_bench();
+#else
     /* clear the screen and start the shell */
     clear();
+#endif
     execute((uint8_t *)"shell");
 
 #ifdef RUN_TESTS
@@ -1,7 +1,9 @@
 #include "keyboard.h"
 
+#include "scrollback.h"
 #include "terminal.h"
 #include "terminals.h"
+#include "scheduler.h"
 
 // local functions
 void _keyboard_interrupt_handler();
@@ -14,6 +16,7 @@ static int shift = 0;
 static int caps_lock = 0;
 static int ctrl = 0;
 static int alt = 0;
+static int extended = 0;  // last byte was EXTENDED_PREFIX
 static int char_counter[NUM_TERMINALS] = {0, 0, 0};
 
 // initalize global variables
@@ -22,6 +25,7 @@ int keyboard_buffer_head[NUM_TERMINALS] = {0};  // index of first character, inc
 int keyboard_buffer_tail[NUM_TERMINALS] = {0};  // index of last character + 1
 int length[NUM_TERMINALS] = {0};
 volatile int enter_flag[NUM_TERMINALS] = {0};  // whether enter has been pressed
+wait_queue_t enter_queue[NUM_TERMINALS];       // processes in terminal_read waiting for enter
 
 // scancode to ascii conversion from https://stackoverflow.com/questions/61124564/convert-scancodes-to-ascii
 const char kbd_US[2 * SCANCODES_LEN] =
@@ -105,11 +109,16 @@ void _keyboard_interrupt_handler() {
         // released would turn off (0) the modifier
         case LEFT_SHIFT_PRESSED:
         case RIGHT_SHIFT_PRESSED:
-            shift = 1;
+            // an extended shift is made up by the keyboard around a grey key, not a real one
+            if (!extended) {
+                shift = 1;
+            }
             break;
         case LEFT_SHIFT_RELEASED:
         case RIGHT_SHIFT_RELEASED:
-            shift = 0;
+            if (!extended) {
+                shift = 0;
+            }
             break;
         case CAPS_LOCK_PRESSED:
             // caps lock is toggled each time it's pressed
@@ -148,17 +157,37 @@ void _keyboard_interrupt_handler() {
                 switch_terminal(2);
             }
             break;
+        case PAGE_UP:
+            if (shift) {
+                // look back through the lines that scrolled off the top
+                scrollback_scroll(SCROLLBACK_PAGE);
+            }
+            break;
+        case PAGE_DOWN:
+            if (shift) {
+                scrollback_scroll(-SCROLLBACK_PAGE);
+            }
+            break;
+        case EXTENDED_PREFIX:
+            break;
         default:
             // check if valid scan code
             if (key >= 0 && key < SCANCODES_LEN) {
+                // typing goes back to the live screen, so the echo can be seen
+                scrollback_end();
+                // typing always echoes to the terminal on screen, whichever terminal is running
+                int output_terminal = get_screen_terminal();
+                set_screen_terminal(curr_foreground_terminal);
                 // update the keyboard buffer and send key to screen
                 // while keeping track of last character deleted if backspace
                 char lastChar = update_keyboard_buffer(key);
                 send_to_screen(key, lastChar);
+                set_screen_terminal(output_terminal);
             }
             break;
     }
 
+    extended = key == EXTENDED_PREFIX;
     // send eoi to IRQ1, the port that keyboard occupies on PIC
     send_eoi(KEYBOARD_IRQ_NUM);
     // end critical section
@@ -236,6 +265,7 @@ void send_to_screen(char key, char lastChar) {
                 break;
             case '\n':
                 enter_flag[curr_foreground_terminal] = 1;  // set enter_flag to 1 to indicate enter has been pressed
+                wake_up(&enter_queue[curr_foreground_terminal]);
                 char_counter[curr_foreground_terminal] = -1;
             default:
                 terminal_write(0, &to_screen, 1);  // send the ascii and let terminal driver decide what to do
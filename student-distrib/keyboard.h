@@ -3,6 +3,7 @@
 
 #include "i8259.h"
 #include "lib.h"
+#include "scheduler.h"
 #include "types.h"
 
 #define KEYBOARD_DATA_PORT 0x60
@@ -23,6 +24,9 @@
 #define F1 0x3b
 #define F2 0x3c
 #define F3 0x3d
+#define PAGE_UP 0x49
+#define PAGE_DOWN 0x51
+#define EXTENDED_PREFIX 0xE0  // sent before the scancode of the grey keys (PgUp, PgDn, arrows...)
 
 #define ESC 27
 
@@ -36,6 +40,7 @@ extern int keyboard_buffer_head[NUM_TERMINALS];
 extern int keyboard_buffer_tail[NUM_TERMINALS];
 extern int length[NUM_TERMINALS];
 extern volatile int enter_flag[NUM_TERMINALS];
+extern wait_queue_t enter_queue[NUM_TERMINALS];
 
 // scancode for keyboard input
 extern const char kbd_US[2 * SCANCODES_LEN];
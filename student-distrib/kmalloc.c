@@ -0,0 +1,153 @@
+// kmalloc.c - kernel heap, one slab cache per power of two object size, slabs are frames from the frame pool
+
+#include "kmalloc.h"
+
+#include "lib.h"
+#include "paging.h"
+
+// slabs of each size class that still have free objects, doubly linked
+static slab_t* partial_slabs[KMALLOC_NUM_CACHES];
+
+static slab_t* new_slab(int cache_idx);
+static void unlink_slab(slab_t* slab);
+
+/*
+ * kmalloc
+ *   DESCRIPTION: hands out an object from the smallest size class that
+ *                fits size. a new slab is taken from the frame pool when
+ *                the class has no free objects left
+ *   INPUTS: size -- number of bytes needed
+ *   OUTPUTS: none
+ *   RETURN VALUE: pointer to the memory, aligned to 16 bytes, NULL for
+ *                 a size of 0 or above KMALLOC_MAX_SIZE, or when the
+ *                 frame pool is empty
+ *   SIDE EFFECTS: memory is not zeroed, safe to call from interrupt handlers
+ */
+void* kmalloc(uint32_t size) {
+    uint32_t flags;
+    int cache_idx = 0;
+    uint32_t obj_size = KMALLOC_MIN_SIZE;
+    slab_t* slab;
+    void* obj;
+    if (size == 0 || size > KMALLOC_MAX_SIZE) {
+        return NULL;
+    }
+    while (obj_size < size) {
+        obj_size <<= 1;
+        cache_idx++;
+    }
+    cli_and_save(flags);
+    slab = partial_slabs[cache_idx];
+    if (slab == NULL) {
+        slab = new_slab(cache_idx);
+        if (slab == NULL) {
+            restore_flags(flags);
+            return NULL;
+        }
+    }
+    obj = slab->free_list;
+    slab->free_list = *(void**)obj;
+    slab->in_use++;
+    // a full slab leaves the list until something in it is freed
+    if (slab->free_list == NULL) {
+        unlink_slab(slab);
+    }
+    restore_flags(flags);
+    return obj;
+}
+
+/*
+ * kfree
+ *   DESCRIPTION: gives an object back to its slab, found from the page
+ *                the object is in. a slab that becomes empty goes back
+ *                to the frame pool unless it is the only one its class
+ *                has with free objects
+ *   INPUTS: ptr -- memory from kmalloc, or NULL
+ *   OUTPUTS: none
+ *   RETURN VALUE: none
+ *   SIDE EFFECTS: safe to call from interrupt handlers
+ */
+void kfree(void* ptr) {
+    uint32_t flags;
+    slab_t* slab;
+    if (ptr == NULL) {
+        return;
+    }
+    slab = (slab_t*)((uint32_t)ptr & ZERO_ATTRIBUTE);
+    cli_and_save(flags);
+    if (slab->free_list == NULL) {
+        // was full, so it isn't on the list
+        slab->prev = NULL;
+        slab->next = partial_slabs[slab->cache_idx];
+        if (slab->next != NULL) {
+            slab->next->prev = slab;
+        }
+        partial_slabs[slab->cache_idx] = slab;
+    }
+    *(void**)ptr = slab->free_list;
+    slab->free_list = ptr;
+    slab->in_use--;
+    // keep one empty slab around so alternating kmalloc/kfree doesn't hit the frame pool every time
+    if (slab->in_use == 0 && (slab->prev != NULL || slab->next != NULL)) {
+        unlink_slab(slab);
+        put_frame((uint32_t)slab);
+    }
+    restore_flags(flags);
+}
+
+/*
+ * new_slab
+ *   DESCRIPTION: takes a frame from the frame pool and cuts it into free
+ *                objects of a size class, after the slab header
+ *   INPUTS: cache_idx -- size class of the slab
+ *   OUTPUTS: none
+ *   RETURN VALUE: the slab, now first on the class's list, NULL if the
+ *                 frame pool is empty
+ *   SIDE EFFECTS: must be called with interrupts off
+ */
+static slab_t* new_slab(int cache_idx) {
+    uint32_t obj_size = KMALLOC_MIN_SIZE << cache_idx;
+    uint32_t offset;
+    slab_t* slab = (slab_t*)alloc_frame();
+    void** prev_obj;
+    if (slab == NULL) {
+        return NULL;
+    }
+    slab->in_use = 0;
+    slab->cache_idx = cache_idx;
+    // chain the objects together, lowest address first
+    prev_obj = &slab->free_list;
+    for (offset = SLAB_HEADER_SIZE; offset + obj_size <= KB_OFFSET; offset += obj_size) {
+        *prev_obj = (uint8_t*)slab + offset;
+        prev_obj = (void**)((uint8_t*)slab + offset);
+    }
+    *prev_obj = NULL;
+    slab->prev = NULL;
+    slab->next = partial_slabs[cache_idx];
+    if (slab->next != NULL) {
+        slab->next->prev = slab;
+    }
+    partial_slabs[cache_idx] = slab;
+    return slab;
+}
+
+/*
+ * unlink_slab
+ *   DESCRIPTION: takes a slab off its class's list of slabs with free objects
+ *   INPUTS: slab -- slab to take off
+ *   OUTPUTS: none
+ *   RETURN VALUE: none
+ *   SIDE EFFECTS: must be called with interrupts off
+ */
+static void unlink_slab(slab_t* slab) {
+    if (slab->prev != NULL) {
+        slab->prev->next = slab->next;
+    } else {
+        partial_slabs[slab->cache_idx] = slab->next;
+    }
+    if (slab->next != NULL) {
+        slab->next->prev = slab->prev;
+    }
+    slab->prev = NULL;
+    slab->next = NULL;
+}
@@ -0,0 +1,29 @@
+#ifndef _KMALLOC_H
+#define _KMALLOC_H
+
+#include "types.h"
+
+#define KMALLOC_MIN_SIZE 16     // smallest object size class in bytes
+#define KMALLOC_MAX_SIZE 1024   // largest object size class in bytes, bigger requests fail (2048 would fit once in a slab)
+#define KMALLOC_NUM_CACHES 7    // size classes 16, 32, ... KMALLOC_MAX_SIZE, doubling each time
+#define SLAB_HEADER_SIZE 32     // bytes at the start of each slab page kept for the slab_t header
+
+/*
+ * header at the start of every slab, a 4 kB frame cut into objects of one size class
+ * free objects hold a pointer to the next free object of the slab
+ */
+typedef struct slab {
+    struct slab* next;   // next slab of the cache with free objects
+    struct slab* prev;   // previous slab of the cache with free objects
+    void* free_list;     // first free object in this slab
+    uint16_t in_use;     // number of objects handed out
+    uint16_t cache_idx;  // size class the slab belongs to
+} slab_t;
+
+// allocates size bytes of kernel memory, NULL if size is 0 or too big or memory ran out
+void* kmalloc(uint32_t size);
+
+// frees memory from kmalloc, NULL is ignored
+void kfree(void* ptr);
+
+#endif
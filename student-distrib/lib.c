@@ -2,16 +2,23 @@
  * vim:ts=4 noexpandtab */
 
 #include "lib.h"
+#include "scrollback.h"
 #include "terminals.h"
 
 int screen_x = 0;
 int screen_y = 0;
 static int last_x[NUM_TERMINALS][NUM_ROWS];
-static char* video_mem = (char*)VIDEO;
+static char* video_mem = (char*)(TERMINAL_VMEM_PAGE_IDX * KB_OFFSET);  // back buffer of screen_terminal
+static int screen_terminal = 0;  // terminal that screen_x, screen_y and video_mem belong to
+static uint32_t dirty_rows[NUM_TERMINALS];  // bit y set when row y of the back buffer hasn't been flushed
+static int vga_start = 0;        // cell of video memory shown at the top left of the screen, only moved by HW_SCROLL
+static int pending_scrolls = 0;  // scrolls of the foreground back buffer not yet applied to the start address
 
 void enable_cursor(uint8_t cursor_start, uint8_t cursor_end);
 void disable_cursor();
 void scroll_screen();
+static void put_char(uint8_t c);
+static void set_vga_start(int start);
 
 /* void clear(void);
  * Inputs: void
@@ -23,9 +30,37 @@ void clear(void) {
         *(uint8_t*)(video_mem + (i << 1)) = ' ';
         *(uint8_t*)(video_mem + (i << 1) + 1) = ATTRIB;
     }
+    dirty_rows[screen_terminal] = ALL_ROWS_DIRTY;
     screen_x = 0;
     screen_y = 0;
-    update_cursor(screen_x, screen_y);
+    if (screen_terminal == curr_foreground_terminal) {
+        flush_screen();
+        update_cursor(screen_x, screen_y);
+    }
+}
+
+/* void set_screen_terminal(int terminal_id);
+ * Inputs: int terminal_id = terminal that output should go to
+ * Return Value: none
+ * Function: Points putc at a terminal. The cursor of the terminal that was
+ *           being written to is saved and the new one's is loaded. Output
+ *           goes to the terminal's back buffer, the page that holds its
+ *           screen, whether or not it is the one on display */
+void set_screen_terminal(int terminal_id) {
+    terminal_arr[screen_terminal].cursor_x = screen_x;
+    terminal_arr[screen_terminal].cursor_y = screen_y;
+    screen_terminal = terminal_id;
+    screen_x = terminal_arr[terminal_id].cursor_x;
+    screen_y = terminal_arr[terminal_id].cursor_y;
+    video_mem = get_page_addr_from_terminal_id(terminal_id);
+}
+
+/* int get_screen_terminal();
+ * Inputs: none
+ * Return Value: terminal that output currently goes to
+ * Function: Gets the terminal set by set_screen_terminal */
+int get_screen_terminal() {
+    return screen_terminal;
 }
 
 /* Standard printf().
@@ -142,6 +177,9 @@ int32_t printf(int8_t* format, ...) {
         }
         buf++;
     }
+    if (screen_terminal == curr_foreground_terminal) {
+        flush_screen();
+    }
     return (buf - format);
 }
 
@@ -150,12 +188,9 @@ int32_t printf(int8_t* format, ...) {
  *   Return Value: Number of bytes written
  *    Function: Output a string to the console */
 int32_t puts(int8_t* s) {
-    register int32_t index = 0;
-    while (s[index] != '\0') {
-        putc(s[index]);
-        index++;
-    }
-    return index;
+    int32_t len = strlen(s);
+    putbuf((uint8_t*)s, len);
+    return len;
 }
 
 /* void putc(uint8_t c);
@@ -163,10 +198,95 @@ int32_t puts(int8_t* s) {
  * Return Value: void
  *  Function: Output a character to the console */
 void putc(uint8_t c) {
+    put_char(c);
+    if (screen_terminal == curr_foreground_terminal) {
+        update_cursor(screen_x, screen_y);  // update the appreance of cursor
+    }
+}
+
+/* int32_t putbuf(const uint8_t* buf, int32_t n);
+ * Inputs: const uint8_t* buf = characters to print
+ *         int32_t n = number of characters in buf
+ * Return Value: number of characters in buf that aren't '\0'
+ * Function: Output a buffer to the console with putbuf_noflush, then
+ *           flush the rows written to the screen and move the cursor once */
+int32_t putbuf(const uint8_t* buf, int32_t n) {
+    int32_t count = putbuf_noflush(buf, n);
+    end_output();
+    return count;
+}
+
+/* int32_t putbuf_noflush(const uint8_t* buf, int32_t n);
+ * Inputs: const uint8_t* buf = characters to print
+ *         int32_t n = number of characters in buf
+ * Return Value: number of characters in buf that aren't '\0'
+ * Function: Output a buffer to the back buffer without flushing it or
+ *           moving the cursor, for writes that come in pieces. Runs of
+ *           printable characters go straight into the back buffer up to
+ *           the end of the row, the rest goes through put_char. Interrupts
+ *           are off for one run at a time, since the scheduler and the
+ *           keyboard echo can point the screen at another terminal in
+ *           between. end_output finishes the write */
+int32_t putbuf_noflush(const uint8_t* buf, int32_t n) {
+    int32_t i = 0, count = 0;
+    uint32_t flags;
+    uint16_t* cell;
+    while (i < n) {
+        cli_and_save(flags);
+        if (buf[i] >= ' ' && buf[i] < 128) {
+            cell = (uint16_t*)video_mem + NUM_COLS * screen_y + screen_x;
+            while (i < n && screen_x < NUM_COLS && buf[i] >= ' ' && buf[i] < 128) {
+                *cell++ = (ATTRIB << 8) | buf[i++];
+                screen_x++;
+                count++;
+            }
+            dirty_rows[screen_terminal] |= 1 << screen_y;
+            if (screen_x == NUM_COLS) {
+                // wrap to the next line the same way put_char does
+                last_x[screen_terminal][screen_y] = screen_x;
+                if (screen_y == NUM_ROWS - 1) {
+                    scroll_screen();
+                } else {
+                    screen_y++;
+                }
+                screen_x = 0;
+            }
+        } else {
+            if (buf[i] != '\0') {
+                count++;
+            }
+            put_char(buf[i++]);
+        }
+        restore_flags(flags);
+    }
+    return count;
+}
+
+/* void end_output();
+ * Inputs: none
+ * Return Value: void
+ * Function: Finishes a write done with putbuf_noflush. If the terminal
+ *           being written to is on screen, its dirty rows are flushed and
+ *           the cursor is moved to where the output stopped */
+void end_output() {
+    uint32_t flags;
+    cli_and_save(flags);
+    if (screen_terminal == curr_foreground_terminal) {
+        flush_screen();
+        update_cursor(screen_x, screen_y);
+    }
+    restore_flags(flags);
+}
+
+/* void put_char(uint8_t c);
+ * Inputs: uint_8* c = character to print
+ * Return Value: void
+ *  Function: Output a character to the console without moving the cursor */
+static void put_char(uint8_t c) {
     if (c == '\0' || c >= 128) {  // disable extended ascii support
         return;
     } else if (c == '\n' || c == '\r') {  // if enter is pressed
-        last_x[curr_foreground_terminal][screen_y] = screen_x;      // save line's last character location
+        last_x[screen_terminal][screen_y] = screen_x;      // save line's last character location
         if (screen_y == NUM_ROWS - 1) {
             scroll_screen();  // reached bottom of the screen, SCROLL
         } else {
@@ -177,24 +297,30 @@ void putc(uint8_t c) {
         if (screen_x == 0 && screen_y != 0) {
             // backspace at beginning of line, wrap around to last character in previous line
             screen_y--;
-            screen_x = max(0, last_x[curr_foreground_terminal][screen_y] - 1);
+            screen_x = max(0, last_x[screen_terminal][screen_y] - 1);
             *(uint8_t*)(video_mem + ((NUM_COLS * screen_y + screen_x) << 1)) = 0;  // clean the current cursor index
             *(uint8_t*)(video_mem + ((NUM_COLS * screen_y + screen_x) << 1) + 1) = ATTRIB;
+            dirty_rows[screen_terminal] |= 1 << screen_y;
         } else if (!(screen_x == 0 && screen_y == 0)) {                            // ignore the press if the cursor is at top-left corner
             screen_x = (screen_x - 1 + NUM_COLS) % NUM_COLS;                       // move screen_x back by 1 or to the end if at the beginning
             screen_y = (screen_y - ((screen_x + 1) / NUM_COLS)) % NUM_ROWS;        // move screen_y up by one if screen_x was at the beginning
             *(uint8_t*)(video_mem + ((NUM_COLS * screen_y + screen_x) << 1)) = 0;  // clean the current cursor index
             *(uint8_t*)(video_mem + ((NUM_COLS * screen_y + screen_x) << 1) + 1) = ATTRIB;
+            dirty_rows[screen_terminal] |= 1 << screen_y;
         }
     } else if (c == '\t') {                                                    // if tab is pressed
-        puts("    ");                                                          // print 4 spaces
+        int i;
+        for (i = 0; i < TAB_WIDTH; i++) {
+            put_char(' ');                                                     // print 4 spaces
+        }
     } else {                                                                   // for every other characters to print
         *(uint8_t*)(video_mem + ((NUM_COLS * screen_y + screen_x) << 1)) = c;  // print the actual character
         *(uint8_t*)(video_mem + ((NUM_COLS * screen_y + screen_x) << 1) + 1) = ATTRIB;
+        dirty_rows[screen_terminal] |= 1 << screen_y;
         screen_x++;  // increment the x index
         if (screen_x == NUM_COLS) {
             // text has gone past the end of the screen, set last flag at end
-            last_x[curr_foreground_terminal][screen_y] = screen_x;
+            last_x[screen_terminal][screen_y] = screen_x;
         }
         if (screen_x == NUM_COLS && screen_y == NUM_ROWS - 1) {
             // text on screen has reached the end of the line, scroll and make a new line
@@ -205,7 +331,6 @@ void putc(uint8_t c) {
         }
         screen_x %= NUM_COLS;  // make sure x index is within the viewing window
     }
-    update_cursor(screen_x, screen_y);  // update the appreance of cursor
 }
 
 /* void scroll_screen();
@@ -213,21 +338,28 @@ void putc(uint8_t c) {
  * Return Value: void
  *  Function: Scrolls to make new space for outputting at the bottom of the screen */
 void scroll_screen() {
-    int x, y;
-    for (y = 1; y < NUM_ROWS; y++) {
-        for (x = 0; x < NUM_COLS; x++) {
-            // copy each pixel in video memory up one line (except the top line, which is overwritten)
-            *(uint8_t*)(video_mem + ((NUM_COLS * (y - 1) + x) << 1)) = *(uint8_t*)(video_mem + ((NUM_COLS * y + x) << 1));
-        }
-    }
-    for (x = 0; x < NUM_COLS; x++) {
-        // fill bottom row with null to clear it
-        *(uint8_t*)(video_mem + ((NUM_COLS * (NUM_ROWS - 1) + x) << 1)) = '\0';
-    }
-    for (x = 1; x < NUM_ROWS; x++) {
-        // move past line up one
-        last_x[curr_foreground_terminal][x - 1] = last_x[curr_foreground_terminal][x];
+    uint32_t flags;
+    // the PIT can flush in the middle, the rows and the dirty bits have to move together
+    cli_and_save(flags);
+    // the top row goes into the history before it is overwritten
+    scrollback_push(screen_terminal, (uint16_t*)video_mem);
+    // copy every row up one, whole cells a dword at a time (the top row is overwritten)
+    memcpy_dword(video_mem, video_mem + (NUM_COLS << 1), ((NUM_ROWS - 1) * NUM_COLS << 1) / BYTES_PER_DWORD);
+    // blank the bottom row
+    memset_word(video_mem + ((NUM_ROWS - 1) * NUM_COLS << 1), ATTRIB << 8, NUM_COLS);
+#if HW_SCROLL
+    if (screen_terminal == curr_foreground_terminal) {
+        // the screen will move up a row too when the flush moves the start address, only the new row differs
+        dirty_rows[screen_terminal] = (dirty_rows[screen_terminal] >> 1) | (1 << (NUM_ROWS - 1));
+        pending_scrolls++;
+    } else
+#endif
+    {
+        dirty_rows[screen_terminal] = ALL_ROWS_DIRTY;
     }
+    // move past line up one
+    memmove(&last_x[screen_terminal][0], &last_x[screen_terminal][1], (NUM_ROWS - 1) * sizeof(int));
+    restore_flags(flags);
 }
 
 /* int8_t* itoa(uint32_t value, int8_t* buf, int32_t radix);
@@ -426,6 +558,27 @@ void* memcpy(void* dest, const void* src, uint32_t n) {
     return dest;
 }
 
+/* void* memcpy_dword(void* dest, const void* src, uint32_t n);
+ * Description: Optimized memcpy for whole dwords (no alignment handling)
+ * Inputs:      void* dest = destination of copy
+ *         const void* src = source of copy
+ *              uint32_t n = number of dwords to copy
+ * Return Value: pointer to dest
+ * Function: copy n consecutive dwords of src to dest */
+void* memcpy_dword(void* dest, const void* src, uint32_t n) {
+    asm volatile(
+        "                 \n\
+            movw    %%ds, %%dx      \n\
+            movw    %%dx, %%es      \n\
+            cld                     \n\
+            rep     movsl           \n\
+            "
+        :
+        : "S"(src), "D"(dest), "c"(n)
+        : "edx", "memory", "cc");
+    return dest;
+}
+
 /* void* memmove(void* dest, const void* src, uint32_t n);
  * Description: Optimized memmove (used for overlapping memory areas)
  * Inputs:      void* dest = destination of move
@@ -522,6 +675,7 @@ void test_interrupts(void) {
     for (i = 0; i < NUM_ROWS * NUM_COLS; i++) {
         video_mem[i << 1]++;
     }
+    dirty_rows[screen_terminal] = ALL_ROWS_DIRTY;
 }
 
 /* void enable_cursor(uint8_t cursor_start, uint8_t cursor_end)
@@ -550,13 +704,93 @@ void disable_cursor() {
  * Return Value: void
  * Function: update the cursor position */
 void update_cursor(int x, int y) {
-    uint16_t pos = y * NUM_COLS + x;
+    uint16_t pos = vga_start + y * NUM_COLS + x;  // the cursor is placed in video memory, not on the screen
     outb(0x0F, 0x3D4);
     outb((uint8_t)(pos & 0xFF), 0x3D5);
     outb(0x0E, 0x3D4);
     outb((uint8_t)((pos >> 8) & 0xFF), 0x3D5);
 }
 
+/* void flush_screen()
+ * Inputs: none
+ * Return Value: void
+ * Function: copies the rows of the foreground terminal's back buffer that
+ *           changed since the last flush to video memory, one uncached
+ *           write per cell that changed rather than per character printed.
+ *           called on every PIT tick and at the end of a write. under
+ *           HW_SCROLL, scrolls since the last flush move the start address.
+ *           does nothing while scrollback history is on display */
+void flush_screen() {
+    uint32_t flags, dirty;
+    int y;
+    char* back_buf;
+    cli_and_save(flags);
+    if (scrollback_viewing()) {
+        // history is on screen, the rows stay dirty until the view is back at the bottom
+        restore_flags(flags);
+        return;
+    }
+    dirty = dirty_rows[curr_foreground_terminal];
+#if HW_SCROLL
+    if (pending_scrolls != 0) {
+        vga_start += pending_scrolls * NUM_COLS;
+        if (pending_scrolls >= NUM_ROWS || vga_start + NUM_ROWS * NUM_COLS > VGA_TEXT_CELLS) {
+            // out of video memory, or nothing left to keep, start over and redraw it all
+            vga_start = 0;
+            dirty = ALL_ROWS_DIRTY;
+        }
+        pending_scrolls = 0;
+        set_vga_start(vga_start);
+        // the cursor is placed in video memory, it has to follow the start address
+        if (screen_terminal == curr_foreground_terminal) {
+            update_cursor(screen_x, screen_y);
+        } else {
+            update_cursor(terminal_arr[curr_foreground_terminal].cursor_x, terminal_arr[curr_foreground_terminal].cursor_y);
+        }
+    }
+#endif
+    if (dirty != 0) {
+        back_buf = get_page_addr_from_terminal_id(curr_foreground_terminal);
+        for (y = 0; y < NUM_ROWS; y++) {
+            if (dirty & (1 << y)) {
+                memcpy_dword((char*)VIDEO + ((vga_start + y * NUM_COLS) << 1), back_buf + (y * NUM_COLS << 1), (NUM_COLS << 1) / BYTES_PER_DWORD);
+            }
+        }
+        dirty_rows[curr_foreground_terminal] = 0;
+    }
+    restore_flags(flags);
+}
+
+/* void redraw_screen()
+ * Inputs: none
+ * Return Value: void
+ * Function: draws all of the foreground terminal's back buffer at the
+ *           start of video memory, for a terminal switch and for vidmap,
+ *           which draws at VIDEO */
+void redraw_screen() {
+    uint32_t flags;
+    cli_and_save(flags);
+    if (vga_start != 0 || pending_scrolls != 0) {
+        vga_start = 0;
+        pending_scrolls = 0;
+        set_vga_start(vga_start);
+    }
+    dirty_rows[curr_foreground_terminal] = ALL_ROWS_DIRTY;
+    flush_screen();
+    restore_flags(flags);
+}
+
+/* void set_vga_start(int start)
+ * Inputs: start - cell in video memory to show at the top left of the screen
+ * Return Value: void
+ * Function: sets the CRTC start address, four port writes whatever the offset */
+static void set_vga_start(int start) {
+    outb(CRTC_START_HIGH, VGA_CRTC_INDEX);
+    outb((uint8_t)((start >> 8) & 0xFF), VGA_CRTC_DATA);
+    outb(CRTC_START_LOW, VGA_CRTC_INDEX);
+    outb((uint8_t)(start & 0xFF), VGA_CRTC_DATA);
+}
+
 /* int min(int a, int b)
  * Inputs: ints a and b
  * Return Value: minimum
@@ -11,6 +11,18 @@
 #define NUM_ROWS 25
 #define VIDEO 0xB8000
 #define ATTRIB 0x7
+#define BYTES_PER_DWORD 4
+#define DWORD_ALIGN_MASK 0x3
+#define TAB_WIDTH 4
+#define ALL_ROWS_DIRTY ((1 << NUM_ROWS) - 1)  // dirty row bitmap with every row of the screen set
+
+// set to 1 to scroll the screen on display by moving the VGA start address, 0 to copy the rows up
+#define HW_SCROLL 0
+#define VGA_TEXT_CELLS 16384   // 32 kB of text mode video memory from VIDEO, 2 bytes per cell
+#define VGA_CRTC_INDEX 0x3D4   // CRTC register select port
+#define VGA_CRTC_DATA 0x3D5    // CRTC register data port
+#define CRTC_START_HIGH 0x0C   // CRTC start address, high byte
+#define CRTC_START_LOW 0x0D    // CRTC start address, low byte
 
 extern int screen_x;
 extern int screen_y;
@@ -18,11 +30,18 @@ void update_cursor(int x, int y);
 
 int32_t printf(int8_t* format, ...);
 void putc(uint8_t c);
+int32_t putbuf(const uint8_t* buf, int32_t n);
+int32_t putbuf_noflush(const uint8_t* buf, int32_t n);
+void end_output();
 int32_t puts(int8_t* s);
 int8_t* itoa(uint32_t value, int8_t* buf, int32_t radix);
 int8_t* strrev(int8_t* s);
 uint32_t strlen(const int8_t* s);
 void clear(void);
+void flush_screen();
+void redraw_screen();
+void set_screen_terminal(int terminal_id);
+int get_screen_terminal();
 extern void test_interrupts(void);
 int min(int a, int b);
 int max(int a, int b);
@@ -31,6 +50,7 @@ void* memset(void* s, int32_t c, uint32_t n);
 void* memset_word(void* s, int32_t c, uint32_t n);
 void* memset_dword(void* s, int32_t c, uint32_t n);
 void* memcpy(void* dest, const void* src, uint32_t n);
+void* memcpy_dword(void* dest, const void* src, uint32_t n);
 void* memmove(void* dest, const void* src, uint32_t n);
 int32_t strncmp(const int8_t* s1, const int8_t* s2, uint32_t n);
 int8_t* strcpy(int8_t* dest, const int8_t* src);
@@ -83,6 +103,15 @@ static inline uint32_t inl(port) {
     return val;
 }
 
+/* Reads the low 32 bits of the time stamp counter. The difference of
+ * two reads is right as long as they are less than 2^32 cycles apart */
+static inline uint32_t rdtsc(void) {
+    uint32_t lo, hi;
+    asm volatile("rdtsc"
+                 : "=a"(lo), "=d"(hi));
+    return lo;
+}
+
 /* Writes a byte to a port */
 #define outb(data, port)                    \
     do {                                    \
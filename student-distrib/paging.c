@@ -4,6 +4,33 @@
 
 #include "filesystem.h"
 #include "lib.h"
+#include "terminals.h"
+
+// index of a frame pool frame from its physical address
+#define frame_index(frame) (((frame) - USER_PROG_PA) >> PAGE_SHIFT)
+
+// free frame numbers, used as a stack
+static uint16_t free_frames[USER_FRAME_COUNT];
+static uint32_t free_frame_count;
+
+// number of page table entries (and exec cache entries) using each frame
+static uint16_t frame_refs[USER_FRAME_COUNT];
+
+// end of the frame pool, set from the amount of RAM at boot
+static uint32_t frame_pool_end;
+
+// each pid's page tables for the user program region and the mmap window,
+// allocated from the frame pool the first time the pid is used
+static uint32_t *user_page_table[MAX_PROC];
+static uint32_t *mmap_page_table[MAX_PROC];
+
+// each pid's heap page tables, allocated as its heap grows into them
+static uint32_t *heap_page_table[MAX_PROC][HEAP_PDE_COUNT];
+
+static int32_t fill_user_page(int pid, uint32_t page);
+static int32_t copy_on_write(int pid, uint32_t page);
+static int32_t fill_heap_page(int pid, uint32_t page);
+static void free_heap_pages(int pid, uint32_t first_page);
 
 /*
  * page_directory_init
@@ -39,6 +66,14 @@ void page_directory_init() {
     page_directory[1] = MB_OFFSET | KERNEL_PDE;  // PDE for kernel page
 
     page_directory[VIDMAP_PDE_IDX] = (((int)vidmap_page_table) & ZERO_ATTRIBUTE) | VIDMEM_PTE;
+
+    // kernel only identity map of the frame pool
+    for (i = FRAME_POOL_PDE_IDX; i * MB_OFFSET < frame_pool_end; i++) {
+        page_directory[i] = (MB_OFFSET * i) | FRAME_POOL_PDE;
+    }
+
+    // kernel stacks, filled in as pids get used
+    page_directory[KSTACK_PDE_IDX] = (((int)kstack_page_table) & ZERO_ATTRIBUTE) | TABLE_ATTRIBUTE;
 }
 
 /*
@@ -69,6 +104,12 @@ void page_table_init() {
     // vmem address range: 0xB8000 - 0xB9000
     // offset of 0xB8000 bytes, so page 184
     page_table[VIDMEM_PAGE_IDX] = (VIDMEM_PAGE_IDX * KB_OFFSET) | VIDMEM_PTE;
+#if HW_SCROLL
+    // hardware scrolling moves the screen through all of text mode video memory
+    for (i = VIDMEM_PAGE_IDX + 1; i < VIDMEM_PAGE_IDX + (VGA_TEXT_CELLS << 1) / KB_OFFSET; i++) {
+        page_table[i] = (i * KB_OFFSET) | VIDMEM_PTE;
+    }
+#endif
     // 3 pages for saving screens for 3 processes
     page_table[TERMINAL_VMEM_PAGE_IDX] = (TERMINAL_VMEM_PAGE_IDX * KB_OFFSET) | VIDMEM_PTE;
     page_table[TERMINAL_VMEM_PAGE_IDX + 1] = ((TERMINAL_VMEM_PAGE_IDX + 1) * KB_OFFSET) | VIDMEM_PTE;
@@ -79,12 +120,23 @@ void page_table_init() {
  * paging_init
  *  DESCRIPTION: initalize paging, including directory, table,
  *      and page setup, as well as enabling paging
- *  INPUTS: none
+ *  INPUTS:
+ *      mem_end -- physical address where RAM ends, the frame pool
+ *          covers everything from 8 MB up to it
  *  OUTPUTS: none
  *  RETURN VALUE: none
  *  SIDE EFFECTS: enables and initializes paging
  */
-void paging_init() {
+void paging_init(uint32_t mem_end) {
+    int i;
+    uint32_t frame_count;
+    frame_pool_end = mem_end < FRAME_POOL_MAX_END ? mem_end : FRAME_POOL_MAX_END;
+    frame_count = frame_pool_end > USER_PROG_PA ? (frame_pool_end - USER_PROG_PA) / KB_OFFSET : 0;
+    // every frame starts out free, handed out lowest address first
+    for (i = 0; i < frame_count; i++) {
+        free_frames[i] = frame_count - 1 - i;
+    }
+    free_frame_count = frame_count;
     page_directory_init();           // initialize page_directory
     page_table_init();               // initialize page_table
     paging_address(page_directory);  // set cr3 to page directory address
@@ -92,40 +144,568 @@ void paging_init() {
     flush_tlb();                     // flush TLB
 }
 
+/*
+ * alloc_frame
+ *  DESCRIPTION: takes a 4 kB frame out of the frame pool
+ *  INPUTS: none
+ *  OUTPUTS: none
+ *  RETURN VALUE: physical address of the frame (also its kernel
+ *      address), 0 if the pool is empty
+ *  SIDE EFFECTS: the frame starts with one reference
+ */
+uint32_t alloc_frame() {
+    uint32_t idx;
+    if (free_frame_count == 0) {
+        return 0;
+    }
+    idx = free_frames[--free_frame_count];
+    frame_refs[idx] = 1;
+    return USER_PROG_PA + (idx << PAGE_SHIFT);
+}
+
+/*
+ * get_frame
+ *  DESCRIPTION: adds a reference to a frame that is being shared
+ *  INPUTS:
+ *      frame -- physical address of the frame
+ *  OUTPUTS: none
+ *  RETURN VALUE: none
+ *  SIDE EFFECTS: increments the frame's reference count
+ */
+void get_frame(uint32_t frame) {
+    frame_refs[frame_index(frame)]++;
+}
+
+/*
+ * put_frame
+ *  DESCRIPTION: drops a reference to a frame and returns it to the
+ *      pool when it was the last one
+ *  INPUTS:
+ *      frame -- physical address of the frame
+ *  OUTPUTS: none
+ *  RETURN VALUE: none
+ *  SIDE EFFECTS: decrements the frame's reference count
+ */
+void put_frame(uint32_t frame) {
+    uint32_t idx = frame_index(frame);
+    if (--frame_refs[idx] == 0) {
+        free_frames[free_frame_count++] = idx;
+    }
+}
+
+/*
+ * free_process_pages
+ *  DESCRIPTION: unmaps a process's whole user program region and
+ *      heap and drops its references to the frames behind them
+ *  INPUTS:
+ *      pid -- process whose pages should be released
+ *  OUTPUTS: none
+ *  RETURN VALUE: none
+ *  SIDE EFFECTS: zeroes the process's user page table, frames nobody
+ *      else shares go back to the pool, heap page tables are freed
+ */
+void free_process_pages(int pid) {
+    int i;
+    if (pid < 0 || pid >= MAX_PROC || user_page_table[pid] == NULL) {
+        return;
+    }
+    for (i = 0; i < ENTRIES; i++) {
+        if (user_page_table[pid][i] & PAGE_PRESENT) {
+            put_frame(user_page_table[pid][i] & ZERO_ATTRIBUTE);
+        }
+        user_page_table[pid][i] = 0;
+    }
+    free_heap_pages(pid, 0);
+    for (i = 0; i < HEAP_PDE_COUNT; i++) {
+        if (heap_page_table[pid][i] != NULL) {
+            put_frame((uint32_t)heap_page_table[pid][i]);
+            heap_page_table[pid][i] = NULL;
+        }
+    }
+    pcb_arr[pid]->heap_size = 0;
+}
+
+/*
+ * heap_sbrk
+ *  DESCRIPTION: grows or shrinks the current process's heap, which
+ *      starts at HEAP_PDE_IDX. pages are only given frames when they
+ *      are first touched (see fill_heap_page), shrinking gives back
+ *      the pages that end up wholly past the break
+ *  INPUTS:
+ *      increment -- bytes to add to the heap, negative to shrink it
+ *  OUTPUTS: none
+ *  RETURN VALUE: address of the old break, -1 if the heap would go
+ *      below 0 or past HEAP_MAX_SIZE or a page table couldn't be had
+ *  SIDE EFFECTS: maps new heap page tables and flushes the TLB
+ */
+int32_t heap_sbrk(int32_t increment) {
+    int pid = curr_pcb->process_id;
+    uint32_t old_size = curr_pcb->heap_size;
+    uint32_t new_size = old_size + increment;
+    uint32_t table;
+    int i;
+    if ((increment < 0 && (uint32_t)-increment > old_size) || (increment > 0 && increment > HEAP_MAX_SIZE - old_size)) {
+        return -1;
+    }
+    /* every 4 MB the heap reaches needs its page table */
+    for (i = 0; i * MB_OFFSET < new_size; i++) {
+        if (heap_page_table[pid][i] == NULL) {
+            table = alloc_frame();
+            if (table == 0) {
+                return -1;
+            }
+            memset_dword((void *)table, 0, KB_OFFSET / BYTES_PER_ENTRY);
+            heap_page_table[pid][i] = (uint32_t *)table;
+        }
+    }
+    curr_pcb->heap_size = new_size;
+    if (new_size < old_size) {
+        free_heap_pages(pid, (new_size + KB_OFFSET - 1) >> PAGE_SHIFT);
+    }
+    map_process_pages(pid);
+    return (HEAP_PDE_IDX << VIDMAP_PDE_IDX_POS) + old_size;
+}
+
+/*
+ * free_heap_pages
+ *  DESCRIPTION: unmaps a process's heap pages from a page on and
+ *      gives their frames back
+ *  INPUTS:
+ *      pid -- process whose heap pages should be released
+ *      first_page -- page number within the heap to start at
+ *  OUTPUTS: none
+ *  RETURN VALUE: none
+ *  SIDE EFFECTS: zeroes PTEs, the caller flushes the TLB
+ */
+static void free_heap_pages(int pid, uint32_t first_page) {
+    uint32_t page;
+    uint32_t *table;
+    for (page = first_page; page < HEAP_PDE_COUNT * ENTRIES; page++) {
+        table = heap_page_table[pid][page / ENTRIES];
+        if (table == NULL) {
+            /* tables past the first missing one were never made */
+            return;
+        }
+        if (table[page % ENTRIES] & PAGE_PRESENT) {
+            put_frame(table[page % ENTRIES] & ZERO_ATTRIBUTE);
+        }
+        table[page % ENTRIES] = 0;
+    }
+}
+
+/*
+ * fill_heap_page
+ *  DESCRIPTION: gives a heap page below the break a zeroed frame on
+ *      its first touch
+ *  INPUTS:
+ *      pid -- process the page belongs to
+ *      page -- page number within the heap
+ *  OUTPUTS: none
+ *  RETURN VALUE: 0 if the page was mapped, -1 if it is past the break
+ *      or out of frames
+ *  SIDE EFFECTS: fills the PTE, the caller flushes the TLB
+ */
+static int32_t fill_heap_page(int pid, uint32_t page) {
+    uint32_t frame;
+    if (page >= (pcb_arr[pid]->heap_size + KB_OFFSET - 1) >> PAGE_SHIFT) {
+        return -1;
+    }
+    frame = alloc_frame();
+    if (frame == 0) {
+        return -1;
+    }
+    memset_dword((void *)frame, 0, KB_OFFSET / BYTES_PER_ENTRY);
+    heap_page_table[pid][page / ENTRIES][page % ENTRIES] = frame | USER_PROG_PTE;
+    return 0;
+}
+
+/*
+ * alloc_process_memory
+ *  DESCRIPTION: gives a pid its kernel stack, mapped at KS_SIZE * pid
+ *      past KSTACK_BASE, and its user program and mmap page tables.
+ *      a pid keeps them after its process exits, so this only takes
+ *      frames the first time the pid is used
+ *  INPUTS:
+ *      pid -- pid that is about to be used
+ *  OUTPUTS: none
+ *  RETURN VALUE: 0 for success, -1 if the frame pool ran out
+ *  SIDE EFFECTS: maps the kernel stack pages and flushes the TLB
+ */
+int32_t alloc_process_memory(int pid) {
+    int i;
+    uint32_t frame;
+    if (pid < 0 || pid >= MAX_PROC) {
+        return -1;
+    }
+    for (i = 0; i < KSTACK_PAGES; i++) {
+        if (!(kstack_page_table[pid * KSTACK_PAGES + i] & PAGE_PRESENT)) {
+            frame = alloc_frame();
+            if (frame == 0) {
+                return -1;
+            }
+            kstack_page_table[pid * KSTACK_PAGES + i] = frame | KSTACK_PTE;
+        }
+    }
+    flush_tlb();
+    if (user_page_table[pid] == NULL) {
+        frame = alloc_frame();
+        if (frame == 0) {
+            return -1;
+        }
+        memset_dword((void *)frame, 0, KB_OFFSET / BYTES_PER_ENTRY);
+        user_page_table[pid] = (uint32_t *)frame;
+    }
+    if (mmap_page_table[pid] == NULL) {
+        frame = alloc_frame();
+        if (frame == 0) {
+            return -1;
+        }
+        memset_dword((void *)frame, 0, KB_OFFSET / BYTES_PER_ENTRY);
+        mmap_page_table[pid] = (uint32_t *)frame;
+    }
+    return 0;
+}
+
+/*
+ * process_memory_available
+ *  DESCRIPTION: checks, without taking anything, that the frame pool
+ *      has enough frames left for alloc_process_memory on the pid and
+ *      for the first pages of the program it starts
+ *  INPUTS:
+ *      pid -- pid that is about to be used
+ *  OUTPUTS: none
+ *  RETURN VALUE: 1 if a process can be started with the pid, 0 if not
+ *  SIDE EFFECTS: none
+ */
+int32_t process_memory_available(int pid) {
+    int i;
+    uint32_t needed = PROCESS_START_FRAMES;
+    if (pid < 0 || pid >= MAX_PROC) {
+        return 0;
+    }
+    for (i = 0; i < KSTACK_PAGES; i++) {
+        if (!(kstack_page_table[pid * KSTACK_PAGES + i] & PAGE_PRESENT)) {
+            needed++;
+        }
+    }
+    if (user_page_table[pid] == NULL) {
+        needed++;
+    }
+    if (mmap_page_table[pid] == NULL) {
+        needed++;
+    }
+    return free_frame_count >= needed;
+}
+
 /*
  * load_program
- *  DESCRIPTION: setup page at 128 MB VA for user program image
- *      and load program image into page
+ *  DESCRIPTION: setup the 4 kB pages at 128 MB VA for the user program
+ *      image. with DEMAND_PAGING every page starts not present and is
+ *      filled by handle_page_fault on first touch, otherwise the image
+ *      and stack pages are filled in up front
  *  INPUTS:
  *      command -- the command from the execute syscall
  *  OUTPUTS:
  *      prog_eip -- the prog_eip, extracted from bytes 24-27 of the program image
- *  RETURN VALUE: none
- *  SIDE EFFECTS: re-maps page at 128 MB VA to 8 MB + pid_count * 4 MB in PA, and
- *      outputs the program eip to prog_eip
+ *  RETURN VALUE: 0 for success, -1 for failure
+ *  SIDE EFFECTS: re-maps the page table at 128 MB VA to the current process's
+ *      table, and outputs the program eip to prog_eip
  */
 uint32_t load_program(const uint8_t *command, uint32_t *prog_eip) {
     /* check for garbage input values */
     if (command == NULL || prog_eip == NULL) {
         return -1;
     }
-    int status;
+    int status, i;
+    int pid = curr_pcb->process_id;
     dentry_t dir_entry;
     /* make sure the file is an executable file */
     status = exec_file_check(command, prog_eip, &dir_entry);
     if (status == -1) {
         return -1;
     }
-    /* map the user program page to be 8MB + (process number * 4MB) in physical memory */
-    page_directory[USER_PROG_IDX] = (USER_PROG_PA + (MB_OFFSET * curr_pcb->process_id)) | USER_PROG_PDE;
-    /* flush the TLB after swapping the page */
-    flush_tlb();
-    /* read the data into VA 0x8048000 */
-    inode_t file_inode = filesystem.inodes[dir_entry.inode_num];
-    status = read_data(dir_entry.inode_num, 0, (uint8_t *)(USER_PROG_IDX * MB_OFFSET + USER_PROG_PAGE_OFFSET), file_inode.length);
-    if (status == -1) {
-        return -1;
+    curr_pcb->exec_inode = dir_entry.inode_num;
+    curr_pcb->exec_length = filesystem.inodes[dir_entry.inode_num].length;
+    /* drop whatever the last process with this pid had mapped */
+    free_process_pages(pid);
+    map_process_pages(pid);
+    if (!DEMAND_PAGING) {
+        /* fill the pages holding the image at VA 0x8048000 and the top of the user stack */
+        for (i = 0; i * KB_OFFSET < curr_pcb->exec_length; i++) {
+            if (fill_user_page(pid, USER_PROG_PAGE_OFFSET / KB_OFFSET + i) == -1) {
+                return -1;
+            }
+        }
+        if (fill_user_page(pid, ENTRIES - 1) == -1) {
+            return -1;
+        }
+        flush_tlb();
     }
     /* if the read into the userpsace VA space was successful, return 0 upon exit */
     return 0;
 }
+
+/*
+ * handle_page_fault
+ *  DESCRIPTION: fixes up a fault in the current process's user program
+ *      region. missing pages are filled in by fill_user_page, writes to
+ *      shared image pages get a private copy of the page
+ *  INPUTS:
+ *      error_code -- error code pushed by the processor
+ *      fault_addr -- faulting virtual address (cr2)
+ *  OUTPUTS: none
+ *  RETURN VALUE: 0 if the fault was handled, -1 if the fault is a real error
+ *      or there is no process yet
+ *  SIDE EFFECTS: maps the page in the current process's user page table, counts the fault for the process
+ */
+int32_t handle_page_fault(uint32_t error_code, uint32_t fault_addr) {
+    int pid;
+    uint32_t page;
+    uint32_t pde_idx = fault_addr >> VIDMAP_PDE_IDX_POS;
+    /* a fault before the first process is a kernel bug, nothing to fill in */
+    if (curr_pcb == NULL) {
+        return -1;
+    }
+    pid = curr_pcb->process_id;
+    curr_pcb->stats.page_faults++;
+    /* the heap is demand zero, only pages below the break can be touched */
+    if (pde_idx >= HEAP_PDE_IDX && pde_idx < HEAP_PDE_IDX + HEAP_PDE_COUNT && !(error_code & PF_PRESENT_ERR)) {
+        if (fill_heap_page(pid, (fault_addr - (HEAP_PDE_IDX << VIDMAP_PDE_IDX_POS)) >> PAGE_SHIFT) == -1) {
+            return -1;
+        }
+        flush_tlb();
+        return 0;
+    }
+    /* only faults in the user program region can be fixed */
+    if (pde_idx != USER_PROG_IDX) {
+        return -1;
+    }
+    page = (fault_addr >> PAGE_SHIFT) & (ENTRIES - 1);
+    if (!(error_code & PF_PRESENT_ERR)) {
+        if (fill_user_page(pid, page) == -1) {
+            return -1;
+        }
+        /* a write to a page that just got mapped shared still needs its own copy */
+        if (!(error_code & PF_WRITE_ERR) || !(user_page_table[pid][page] & PTE_COW)) {
+            flush_tlb();
+            return 0;
+        }
+    }
+    if ((error_code & PF_WRITE_ERR) && (user_page_table[pid][page] & PTE_COW)) {
+        return copy_on_write(pid, page);
+    }
+    return -1;
+}
+
+/*
+ * fill_user_page
+ *  DESCRIPTION: maps a not present page of a process's user program
+ *      region. image pages of a cached executable map the frame the
+ *      exec cache shares between every process running it, read only.
+ *      other pages get a private zeroed frame with whatever part of the
+ *      image falls in it read from the executable's inode
+ *  INPUTS:
+ *      pid -- process the page belongs to
+ *      page -- page number within the user program region
+ *  OUTPUTS: none
+ *  RETURN VALUE: 0 if the page was mapped, -1 if out of frames or the read failed
+ *  SIDE EFFECTS: fills the PTE, the caller flushes the TLB
+ */
+static int32_t fill_user_page(int pid, uint32_t page) {
+    pcb_t *pcb = pcb_arr[pid];
+    exec_cache_entry_t *entry;
+    uint32_t frame;
+    int32_t image_page = page - USER_PROG_PAGE_OFFSET / KB_OFFSET;
+    int32_t image_offset = image_page * KB_OFFSET;
+    int is_image = image_page >= 0 && image_offset < pcb->exec_length;
+    entry = exec_cache_lookup(pcb->exec_inode);
+    if (is_image && entry != NULL && image_page < EXEC_CACHE_PAGES) {
+        frame = entry->frames[image_page];
+        if (frame == 0) {
+            /* first process to touch this page, the exec cache keeps the first reference */
+            frame = alloc_frame();
+            if (frame == 0) {
+                return -1;
+            }
+            memset_dword((void *)frame, 0, KB_OFFSET / BYTES_PER_ENTRY);
+            if (read_data(pcb->exec_inode, image_offset, (uint8_t *)frame, KB_OFFSET) == -1) {
+                put_frame(frame);
+                return -1;
+            }
+            entry->frames[image_page] = frame;
+        }
+        get_frame(frame);
+        user_page_table[pid][page] = frame | USER_TEXT_PTE;
+        return 0;
+    }
+    frame = alloc_frame();
+    if (frame == 0) {
+        return -1;
+    }
+    memset_dword((void *)frame, 0, KB_OFFSET / BYTES_PER_ENTRY);
+    if (is_image && read_data(pcb->exec_inode, image_offset, (uint8_t *)frame, KB_OFFSET) == -1) {
+        put_frame(frame);
+        return -1;
+    }
+    user_page_table[pid][page] = frame | USER_PROG_PTE;
+    return 0;
+}
+
+/*
+ * copy_on_write
+ *  DESCRIPTION: gives a process a writable copy of a shared image page.
+ *      if nothing else uses the frame anymore it is just made writable
+ *  INPUTS:
+ *      pid -- process that wrote the page
+ *      page -- page number within the user program region
+ *  OUTPUTS: none
+ *  RETURN VALUE: 0 for success, -1 if out of frames
+ *  SIDE EFFECTS: remaps the PTE and flushes the TLB
+ */
+static int32_t copy_on_write(int pid, uint32_t page) {
+    uint32_t old_frame = user_page_table[pid][page] & ZERO_ATTRIBUTE;
+    uint32_t new_frame;
+    if (frame_refs[frame_index(old_frame)] == 1) {
+        user_page_table[pid][page] = old_frame | USER_PROG_PTE;
+    } else {
+        new_frame = alloc_frame();
+        if (new_frame == 0) {
+            return -1;
+        }
+        memcpy_dword((void *)new_frame, (void *)old_frame, KB_OFFSET / BYTES_PER_ENTRY);
+        user_page_table[pid][page] = new_frame | USER_PROG_PTE;
+        put_frame(old_frame);
+    }
+    flush_tlb();
+    return 0;
+}
+
+/*
+ * map_process_pages
+ *  DESCRIPTION: points the page directory at a process's user
+ *      program page table, its mmap page table and its heap page tables
+ *  INPUTS:
+ *      pid -- process whose pages should be mapped
+ *  OUTPUTS: none
+ *  RETURN VALUE: none
+ *  SIDE EFFECTS: swaps the page tables at 128 MB, 136 MB and 144 MB VA up
+ *      and flushes the TLB
+ */
+void map_process_pages(int pid) {
+    if (pid < 0 || pid >= MAX_PROC || user_page_table[pid] == NULL) {
+        return;
+    }
+    int i;
+    page_directory[USER_PROG_IDX] = (((int)user_page_table[pid]) & ZERO_ATTRIBUTE) | USER_TABLE_PDE;
+    page_directory[MMAP_PDE_IDX] = (((int)mmap_page_table[pid]) & ZERO_ATTRIBUTE) | VIDMEM_PTE;
+    /* heap page tables that don't exist yet are left not present */
+    for (i = 0; i < HEAP_PDE_COUNT; i++) {
+        page_directory[HEAP_PDE_IDX + i] = heap_page_table[pid][i] == NULL ? 0 : (((int)heap_page_table[pid][i]) & ZERO_ATTRIBUTE) | USER_TABLE_PDE;
+    }
+    /* flush the TLB after swapping the pages */
+    flush_tlb();
+}
+
+/*
+ * mmap_file
+ *  DESCRIPTION: maps every data block of a file read only into the
+ *      next free pages of the current process's mmap window. data
+ *      blocks are 4 kB and the filesystem module is page aligned, so
+ *      each block gets its own PTE and nothing is copied
+ *  INPUTS:
+ *      inode -- inode number of the file to map
+ *  OUTPUTS:
+ *      start -- user address the first byte of the file is mapped at
+ *  RETURN VALUE: length of the file in bytes, -1 for failure
+ *  SIDE EFFECTS: fills PTEs in the current process's mmap page table
+ *      and flushes the TLB
+ */
+int32_t mmap_file(uint32_t inode, uint8_t **start) {
+    inode_t *file_inode;
+    int32_t num_blocks;
+    uint32_t first_page;
+    int32_t data_block_idx;
+    int i;
+    /* the block count is only known for inodes that passed the mount check */
+    num_blocks = inode_block_count(inode);
+    if (start == NULL || num_blocks == -1) {
+        return -1;
+    }
+    /* blocks can only be mapped if they sit on page boundaries */
+    if (((uint32_t)filesystem.data_blocks & ~ZERO_ATTRIBUTE) != 0) {
+        return -1;
+    }
+    file_inode = &(filesystem.inodes[inode]);
+    first_page = curr_pcb->mmap_next;
+    /* make sure the whole file fits in what's left of the window */
+    if (num_blocks > ENTRIES - first_page) {
+        return -1;
+    }
+    for (i = 0; i < num_blocks; i++) {
+        data_block_idx = file_inode->data_block_num[i];
+        mmap_page_table[curr_pcb->process_id][first_page + i] = ((uint32_t)&(filesystem.data_blocks[data_block_idx]) & ZERO_ATTRIBUTE) | MMAP_PTE;
+    }
+    curr_pcb->mmap_next += num_blocks;
+    flush_tlb();
+    *start = (uint8_t *)((MMAP_PDE_IDX << VIDMAP_PDE_IDX_POS) | (first_page << VIDMAP_PTE_IDX_POS));
+    return file_inode->length;
+}
+
+/*
+ * clear_mmap_pages
+ *  DESCRIPTION: unmaps everything a process mapped with mmap
+ *  INPUTS:
+ *      pid -- process whose mmap window should be cleared
+ *  OUTPUTS: none
+ *  RETURN VALUE: none
+ *  SIDE EFFECTS: zeroes the process's mmap page table
+ */
+void clear_mmap_pages(int pid) {
+    if (pid < 0 || pid >= MAX_PROC || mmap_page_table[pid] == NULL) {
+        return;
+    }
+    memset(mmap_page_table[pid], 0, SIZE);
+    pcb_arr[pid]->mmap_next = 0;
+}
+
+/*
+ * map_vidmap_page
+ *  DESCRIPTION: points a process's vidmap page at video memory if its
+ *      terminal is on screen, and at its terminal's back buffer if not,
+ *      so a program in the background keeps drawing without touching
+ *      the screen
+ *  INPUTS:
+ *      pid -- process that called vidmap
+ *  OUTPUTS: none
+ *  RETURN VALUE: none
+ *  SIDE EFFECTS: the caller flushes the TLB
+ */
+void map_vidmap_page(int pid) {
+    uint32_t page;
+    if (pcb_arr[pid]->terminal == curr_foreground_terminal) {
+        page = VIDMEM_PAGE_IDX * KB_OFFSET;
+    } else {
+        page = (uint32_t)get_page_addr_from_terminal_id(pcb_arr[pid]->terminal);
+    }
+    vidmap_page_table[pid] = page | VIDMEM_PTE;
+}
+
+/*
+ * remap_vidmap_pages
+ *  DESCRIPTION: redoes map_vidmap_page for every running process that
+ *      called vidmap, after the foreground terminal changed. switching
+ *      terminals moves these pages instead of copying the screen
+ *  INPUTS: none
+ *  OUTPUTS: none
+ *  RETURN VALUE: none
+ *  SIDE EFFECTS: flushes the TLB once
+ */
+void remap_vidmap_pages() {
+    int pid;
+    for (pid = 0; pid < MAX_PROC; pid++) {
+        if (pcb_arr[pid] != NULL && !pcb_arr[pid]->available && (vidmap_page_table[pid] & PAGE_PRESENT)) {
+            map_vidmap_page(pid);
+        }
+    }
+    flush_tlb();
+}
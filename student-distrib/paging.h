@@ -3,6 +3,7 @@
 
 // #include <stdint.h>
 #include "types.h"
+#include "pcb.h"
 // #include "paging_asm.S"
 
 // oh its just like magic! - magic numbers!
@@ -80,6 +81,26 @@
 // vidmap page table entry index
 #define VIDMAP_PTE_IDX 420
 
+// mmap page directory page table index, 4 MB window right after the vidmap page table
+#define MMAP_PDE_IDX (USER_PROG_IDX + 2)
+
+/*
+ * MMAP_PTE
+ * Page Base Addr[31:12] | Available[11:9] | G[8] | PAT[7] | D[6] | A[5] | PCD[4] | PWT[3] | U/S[2] | R/W[1] | P[0]
+ * 00000000000000000000    000               0      0        0      0      0        0        1        0        1
+ * user pages mapped straight onto filesystem data blocks
+ * read only so user programs can't modify the filesystem image
+ */
+#define MMAP_PTE 0x00000005
+
+/*
+ * VSYSCALL_PTE
+ * Page Base Addr[31:12] | Available[11:9] | G[8] | PAT[7] | D[6] | A[5] | PCD[4] | PWT[3] | U/S[2] | R/W[1] | P[0]
+ * 00000000000000000000    000               0      0        0      0      0        0        1        0        1
+ * user read only page of kernel code holding the system call stub
+ */
+#define VSYSCALL_PTE 0x00000005
+
 // vidmap page directory page table index position in 32-bit addr - 12 left shifts to address[21:12]
 #define VIDMAP_PTE_IDX_POS 12
 
@@ -89,6 +110,100 @@
 // user program page offset
 #define USER_PROG_PAGE_OFFSET 0x48000
 
+// number of bits to shift a virtual address by to get its page number
+#define PAGE_SHIFT 12
+
+// set to 1 to fill user program pages on first touch, 0 to fill the image and stack pages in load_program
+#define DEMAND_PAGING 1
+
+// present bit of a page table entry
+#define PAGE_PRESENT 0x1
+
+// page fault error code bit that is set when the page was present (protection violation)
+#define PF_PRESENT_ERR 0x1
+
+// page fault error code bit that is set when the access was a write
+#define PF_WRITE_ERR 0x2
+
+// first page directory entry of the kernel's identity map of the frame pool
+#define FRAME_POOL_PDE_IDX (USER_PROG_PA / MB_OFFSET)
+
+// user pages, kernel stacks and process page tables come out of a pool of 4 kB
+// frames from PA 8 MB to the end of RAM, at most up to the user program VA
+#define FRAME_POOL_MAX_END (USER_PROG_IDX * MB_OFFSET)
+#define USER_FRAME_COUNT ((FRAME_POOL_MAX_END - USER_PROG_PA) / KB_OFFSET)
+
+// frame pool size used when the boot loader doesn't say how much RAM there is
+#define DEFAULT_MEM_END (8 * MB_OFFSET)
+
+// first page directory entry of the user heap, sbrk grows it up from 144 MB VA
+#define HEAP_PDE_IDX (USER_PROG_IDX + 4)
+
+// number of 4 MB page tables the heap can span
+#define HEAP_PDE_COUNT 8
+
+// largest the heap can get in bytes
+#define HEAP_MAX_SIZE (HEAP_PDE_COUNT * MB_OFFSET)
+
+// page directory entry of the 4 MB window the kernel stacks are mapped in
+#define KSTACK_PDE_IDX (KSTACK_BASE / MB_OFFSET)
+
+// number of 4 kB pages in one kernel stack
+#define KSTACK_PAGES (KS_SIZE / KB_OFFSET)
+
+// frames a new process takes on top of its pid's kernel stack and page tables
+// before it can run: the page at its entry point, the top of its user stack,
+// and a kmalloc slab for its arguments
+#define PROCESS_START_FRAMES 3
+
+/*
+ * KSTACK_PTE
+ * Page Base Addr[31:12] | Available[11:9] | G[8] | PAT[7] | D[6] | A[5] | PCD[4] | PWT[3] | U/S[2] | R/W[1] | P[0]
+ * 00000000000000000000    000               0      0        0      0      0        0        0        1        1
+ * supervisor R/W page of a process's kernel stack and PCB
+ */
+#define KSTACK_PTE 0x00000003
+
+/*
+ * FRAME_POOL_PDE
+ * Page Base Addr[31:22] | Reserved[21:13] | PAT[12] | Available[11:9] | G[8] | PS[7] | D[6] | A[5] | PCD[4] | PWT[3] | U/S[2] | R/W[1] | P[0]
+ * 0000000000              000000000         0         000               0      1       0      0      0        0        0        1        1
+ * 4 MB supervisor pages identity mapping the frame pool, so the kernel
+ * can fill and copy frames that aren't mapped in the current process
+ * PCD is 0 so these are cached, the same memory type as the user PTEs
+ * mapping the same frames (PCD set to 1 would turn caching off)
+ */
+#define FRAME_POOL_PDE 0x00000083
+
+// PTE available bit marking a read only page that gets copied on the first write
+#define PTE_COW 0x00000200
+
+/*
+ * USER_TEXT_PTE
+ * Page Base Addr[31:12] | Available[11:9] | G[8] | PAT[7] | D[6] | A[5] | PCD[4] | PWT[3] | U/S[2] | R/W[1] | P[0]
+ * 00000000000000000000    001               0      0        0      0      0        0        1        0        1
+ * user read only program image page shared between processes running
+ * the same executable, copied on write (PTE_COW)
+ */
+#define USER_TEXT_PTE 0x00000205
+
+/*
+ * USER_TABLE_PDE
+ * Page Base Addr[31:12] | Available[11:9] | G[8] | PS[7] | 0 | A[5] | PCD[4] | PWT[3] | U/S[2] | R/W[1] | P[0]
+ * 00000000000000000000    000               0      0       0   0      0        0        1        1        1
+ * page table for the 4 MB user program region, split into 4 kB pages
+ * R/W and U/S are set here so the PTEs decide the access rights
+ */
+#define USER_TABLE_PDE 0x00000007
+
+/*
+ * USER_PROG_PTE
+ * Page Base Addr[31:12] | Available[11:9] | G[8] | PAT[7] | D[6] | A[5] | PCD[4] | PWT[3] | U/S[2] | R/W[1] | P[0]
+ * 00000000000000000000    000               0      0        0      0      0        0        1        1        1
+ * user R/W 4 kB page of a program image, stack, or heap
+ */
+#define USER_PROG_PTE 0x00000007
+
 /*
  * USER_PROG_PDE
  * Page Base Addr[31:22] | Reserved[21:13] | PAT[12] | Available[11:9] | G[8] | PS[7] | D[6] | A[5] | PCD[4] | PWT[3] | U/S[2] | R/W[1] | P[0]
@@ -114,8 +229,11 @@ extern uint32_t page_table[ENTRIES] __attribute__((aligned(SIZE)));
 // vidmap page table
 extern uint32_t vidmap_page_table[ENTRIES] __attribute__((aligned(SIZE)));
 
+// page table of the kernel stack window
+extern uint32_t kstack_page_table[ENTRIES] __attribute__((aligned(SIZE)));
+
 // initializes paging, including enable, directory and page setup
-void paging_init();
+void paging_init(uint32_t mem_end);
 
 // assembly - paging enable function
 extern void paging_enable();
@@ -129,6 +247,45 @@ void page_table_init();
 // loading a progarm into memory
 uint32_t load_program(const uint8_t* command, uint32_t* prog_eip);
 
+// map a process's user program page and mmap page table into the page directory
+void map_process_pages(int pid);
+
+// map a file's data blocks read only into the current process's mmap window
+int32_t mmap_file(uint32_t inode, uint8_t** start);
+
+// remove all of a process's mmap mappings
+void clear_mmap_pages(int pid);
+
+// point a process's vidmap page at the screen or at its terminal's back buffer
+void map_vidmap_page(int pid);
+
+// point every vidmap page at the right place after a terminal switch
+void remap_vidmap_pages();
+
+// take a free frame from the pool, returns its physical address or 0 if none are left
+uint32_t alloc_frame();
+
+// add a reference to a frame
+void get_frame(uint32_t frame);
+
+// drop a reference to a frame, freeing it once nobody uses it
+void put_frame(uint32_t frame);
+
+// release every frame mapped in a process's user program region
+void free_process_pages(int pid);
+
+// make sure a pid has a kernel stack and page tables, returns -1 if out of frames
+int32_t alloc_process_memory(int pid);
+
+// whether there are enough free frames left to start a process with the pid
+int32_t process_memory_available(int pid);
+
+// move the current process's heap break, returns the old break or -1
+int32_t heap_sbrk(int32_t increment);
+
+// fill in a not present user page or copy a shared one on write, returns 0 if the fault was handled
+int32_t handle_page_fault(uint32_t error_code, uint32_t fault_addr);
+
 // assembly - put page directory address into cr3
 extern void paging_address(unsigned int*);
 
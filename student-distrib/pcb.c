@@ -1,16 +1,16 @@
 #include "pcb.h"
 #include "lib.h"
 #include "filesystem.h"
+#include "paging.h"
+#include "scheduler.h"
 #include "types.h"
 
-// // kernel stack base addresses
-// // 0x007FFFFF: bottom of kernel stack 1 at 8MB-1
-// uint32_t KS_1 = KS1; 
-// // 0x007FDFFF: bottom of kernel stack 2 at 8MB-8kB-1
-// uint32_t KS_2 = KS2;
-
 pcb_t* pcb_arr[MAX_PROC];
-pcb_t *curr_pcb = (pcb_t *)PCB1_POS;
+pcb_t *curr_pcb = NULL;  // no process until the first execute, its kernel stack isn't mapped before then
+
+// free pids, used as a stack so the pid that was freed last is reused first
+static uint16_t free_pids[MAX_PROC];
+static int free_pid_count;
 
 /*
  * point_curr_pcb
@@ -34,22 +34,18 @@ int point_curr_pcb(int pcbx) {
 
 /*
  * find_avail_pid
- *   DESCRIPTION: finds pid available in pid_arr 
+ *   DESCRIPTION: finds the pid create_pcb will hand out next
  *   INPUTS: NONE
  *   OUTPUTS: none
- *   RETURN VALUE: first available pid for success, 
+ *   RETURN VALUE: available pid for success, 
  *      -1 for failure
  *   SIDE EFFECTS: NONE
  */
 int find_avail_pid() {
-    int i; // traverse
-    for(i = 0; i < MAX_PROC; i++) { // go through each entry in pid_arr
-        if(pcb_arr[i]->available == 1) { // check if its available
-            pcb_arr[i]->process_id = i;  // set the process id of the pid_arr entry
-            return i; // return index that's available
-        }
+    if (free_pid_count == 0) {
+        return -1; // every pid is taken
     }
-    return -1; // if neither are empty
+    return free_pids[free_pid_count - 1];
 }
 
 /*
@@ -59,11 +55,14 @@ int find_avail_pid() {
  *      pid -- pid we want to clear
  *   OUTPUTS: none
  *   RETURN VALUE: pid num cleared if success, -1 for failure
- *   SIDE EFFECTS: sets specified pid to available in pid_arr
+ *   SIDE EFFECTS: puts the pid back on the free list, its kernel stack
+ *      and page tables stay allocated for the next process with the pid
+ *      (halt is still running on the stack when it clears the pid)
  */
 int clear_pid(int pid) {
-    if ((pid >= 0) && (pid < MAX_PROC)) {  // for each entry
+    if ((pid >= 0) && (pid < MAX_PROC) && pcb_arr[pid] != NULL && !pcb_arr[pid]->available) {
         pcb_arr[pid]->available = 1; // set as available
+        free_pids[free_pid_count++] = pid;
         return pid; // return pid cleared
     }
     return -1; // return for failure
@@ -71,8 +70,9 @@ int clear_pid(int pid) {
 
 /*
  * pcb_arr_init
- *   DESCRIPTION: initializes pcb_arr so that all entries are 
- *      marked as available 
+ *   DESCRIPTION: initializes the pid free list so that all pids
+ *      are available, lowest pid first. PCBs are only set up once
+ *      their pid is first used
  *   INPUTS: NONE
  *   OUTPUTS: NONE
  *   RETURN VALUE: NONE
@@ -81,11 +81,10 @@ int clear_pid(int pid) {
 void pcb_arr_init() {
     int i; // for traversal
     for (i = 0; i < MAX_PROC; i++) {  // for each entry
-        pcb_arr[i] = (pcb_t *)pidToPCB(i);
-        memset((void *)pcb_arr[i], 0, sizeof(pcb_t));
-        start_process(pcb_arr[i]->file_desc);
-        pcb_arr[i]->available = 1;  // set as available
+        pcb_arr[i] = NULL;
+        free_pids[i] = MAX_PROC - 1 - i;
     }
+    free_pid_count = MAX_PROC;
     return;
 }
 
@@ -93,7 +92,8 @@ void pcb_arr_init() {
 /*
  * create_pcb
  *   DESCRIPTION: creates PCB to place in kernel 
- *      space during execute 
+ *      space during execute. the pid's kernel stack and
+ *      page tables are allocated the first time it is used
  *   INPUTS: 
  *      parentID -- process ID of program that called 
  *          it
@@ -102,22 +102,80 @@ void pcb_arr_init() {
  *      curr_esp -- current esp of execute before syscall 
  *          is executed
  *   OUTPUTS: none
- *   RETURN VALUE: pid of process created
- *   SIDE EFFECTS: fills in PCB1 at top of kernel stack
+ *   RETURN VALUE: pid of process created, -1 if there is no
+ *      pid or memory left
+ *   SIDE EFFECTS: fills in the PCB at the bottom of the pid's kernel stack
  */
 int create_pcb(int parentID, uint32_t curr_ebp, uint32_t curr_esp) {
     int i; // to store pcb_arr index PCB process ID will be placed in
     i = find_avail_pid(); // find available entry in pcb_arr
+    if (i == -1 || alloc_process_memory(i) == -1) {
+        return -1;
+    }
+    free_pid_count--;
+    pcb_arr[i] = (pcb_t *)pidToPCB(i);
+    memset((void *)pcb_arr[i], 0, sizeof(pcb_t));
+    start_process(pcb_arr[i]->file_desc);
     pcb_arr[i]->available = 0; // set unavailable
     // set PCB attributes
     pcb_arr[i]->process_id = i;
     pcb_arr[i]->parent_id = parentID;
     pcb_arr[i]->saved_esp = curr_esp;
     pcb_arr[i]->saved_ebp = curr_ebp;
+    pcb_arr[i]->mmap_next = 0;
+    // a child keeps its parent's scheduling class
+    pcb_arr[i]->sched_class = parentID == -1 ? SCHED_CLASS_AUTO : pcb_arr[parentID]->sched_class;
     pcb_arr[i]->active = 1;
     return i;
 }
 
+/*
+ * get_proc_infos
+ *   DESCRIPTION: copies the pid, parent, terminal, class, program name
+ *                and counters of every running process, lowest pid first
+ *   INPUTS: buf -- where to put the records
+ *           count -- number of records that fit in buf
+ *   OUTPUTS: the records in buf
+ *   RETURN VALUE: number of records copied
+ *   SIDE EFFECTS: none
+ */
+int32_t get_proc_infos(proc_info_t* buf, int32_t count) {
+    int32_t i, n = 0;
+    for (i = 0; i < MAX_PROC && n < count; i++) {
+        if (pcb_arr[i] == NULL || pcb_arr[i]->available) {
+            continue;
+        }
+        buf[n].pid = pcb_arr[i]->process_id;
+        buf[n].parent_id = pcb_arr[i]->parent_id;
+        buf[n].terminal = pcb_arr[i]->terminal;
+        buf[n].sched_class = pcb_arr[i]->sched_class;
+        memcpy(buf[n].name, pcb_arr[i]->name, PROC_NAME_LEN);
+        buf[n].stats = pcb_arr[i]->stats;
+        n++;
+    }
+    return n;
+}
+
+/*
+ * exec_inode_in_use
+ *   DESCRIPTION: checks whether any running process has inode as its
+ *                program image. its pages are filled from the inode on
+ *                demand, so the file can't change under it
+ *   INPUTS: inode -- inode number of the file
+ *   OUTPUTS: none
+ *   RETURN VALUE: 1 if a running process uses the inode, 0 if not
+ *   SIDE EFFECTS: none
+ */
+int exec_inode_in_use(uint32_t inode) {
+    int i;
+    for (i = 0; i < MAX_PROC; i++) {
+        if (pcb_arr[i] != NULL && !pcb_arr[i]->available && pcb_arr[i]->exec_inode == inode) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
 /*
  * pidToPCB
  *   DESCRIPTION: a helper to find start of PCB for a pid
@@ -127,5 +185,5 @@ int create_pcb(int parentID, uint32_t curr_ebp, uint32_t curr_esp) {
  *   SIDE EFFECTS: none
  */ 
 uint32_t* pidToPCB(uint8_t pid){
-    return (uint32_t*)(KP_BOTTOM - KS_SIZE * (pid + 1) + PCB_SIZE);
+    return (uint32_t*)(KSTACK_BASE + KS_SIZE * pid + PCB_SIZE);
 }
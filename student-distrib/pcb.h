@@ -4,35 +4,67 @@
 #include "types.h"
 
 #define KS_SIZE 8192                                         // each kernel stack is 8192B or 8kB
-#define KP_BOTTOM 8388608                                    // kernel page ends at 8MB
-#define KS1 (KP_BOTTOM - 1)                                  // kernel stack 1 grows from 8MB to lower addresses (exclusive so -1)
-#define KS2 (KP_BOTTOM - KS_SIZE - 1)                        // kernel stack 2 grows from 8MB-8kB to lower addresses (exclusive so -1)
+#define KP_BOTTOM 8388608                                    // kernel page ends at 8MB, the boot stack grows down from here
+#define KSTACK_BASE 0x08C00000                               // kernel stacks are mapped from 140MB VA up, KS_SIZE per pid
 #define FD_SIZE 8                                            // each fd can open max 8 files, including stdin and stdout
 #define PCB_SIZE 256                                         // size of PCB is bytes, aligned to 4
-#define PCB1_POS (KP_BOTTOM - KS_SIZE + PCB_SIZE)            // finding starting addr of PCB1
-#define PCB2_POS (KP_BOTTOM - KS_SIZE - KS_SIZE + PCB_SIZE)  // finding starting addr of PCB2
-#define MAX_PROC 6                                           // max number of processes we can have
+#define PCB1_POS (KSTACK_BASE + PCB_SIZE)                    // finding starting addr of PCB1
+#define PCB2_POS (KSTACK_BASE + KS_SIZE + PCB_SIZE)          // finding starting addr of PCB2
+#define MAX_PROC 256                                         // number of pids, how many processes can run at once depends on free memory
+#define PROC_NAME_LEN 32                                     // longest program name kept in the PCB, same as a file name
 
 /*
  * struct for file_descriptor with file descriptor attributes
+ * block_ptr, block_idx and block_offset are a cursor into the file's
+ * data blocks at file_pos, so sequential file reads pick up where the
+ * last one stopped (block_ptr is NULL until block block_idx is looked up)
+ * rtc_interval and rtc_deadline are an rtc fd's virtual frequency, in
+ * hardware rtc ticks per virtual tick, and the tick of its last read
  */
 typedef struct file_descriptor {
     int32_t* fileops_table_ptr;
     int32_t inode;
     int32_t file_pos;
     int32_t flags;
+    uint8_t* block_ptr;
+    uint32_t block_idx;
+    uint32_t block_offset;
+    uint32_t rtc_interval;
+    uint32_t rtc_deadline;
 } file_descriptor_t;
 
+/*
+ * CPU and I/O a process has used since it started
+ * syscall_asm.S counts system calls through the first word of the PCB,
+ * so syscalls has to stay first here and stats first in pcb_t
+ */
+typedef struct proc_stats {
+    uint32_t syscalls;      // system calls made
+    uint32_t ticks;         // PIT ticks the process was running on
+    uint32_t bytes_read;    // bytes returned by read
+    uint32_t bytes_written; // bytes accepted by write
+    uint32_t page_faults;   // page faults, handled or not
+} proc_stats_t;
+
 /*
  * struct holding all the PCB attributes
  */
 typedef struct pcb {
+    proc_stats_t stats;
     int process_id;
     int parent_id;
     file_descriptor_t file_desc[FD_SIZE];
     uint32_t saved_esp;
     uint32_t saved_ebp;
     uint32_t saved_eip;
+    uint32_t mmap_next;   // next free page in the process's mmap window
+    uint32_t exec_inode;  // inode of the program image, for filling pages on demand
+    uint32_t exec_length; // length of the program image in bytes
+    uint8_t sched_class;  // SCHED_CLASS_* the scheduler runs the process in
+    char* args;           // arguments from the command line, from kmalloc
+    uint32_t heap_size;   // bytes of heap below the break, set by sbrk
+    uint8_t name[PROC_NAME_LEN]; // program the process runs, not NUL terminated at full length
+    uint8_t terminal;     // terminal the process was started on
     uint8_t active;
     uint8_t available;
 } pcb_t;
@@ -46,7 +78,7 @@ extern pcb_t* pcb_arr[MAX_PROC];
 using/active PCB */
 extern pcb_t* curr_pcb;
 
-// called in create_pcb_x
+// called in create_pcb_x, -1 if every pid is taken
 int find_avail_pid();
 
 // need to be called when we are done with the process
@@ -58,9 +90,28 @@ int point_curr_pcb(int pcbx);
 // initialize pid array
 void pcb_arr_init();
 
-// create_pcb_x
+// create_pcb_x, -1 if there is no pid or memory left for it
 int create_pcb(int parentID, uint32_t curr_ebp, uint32_t curr_esp);
 
+/*
+ * one process in the getprocs system call's buffer
+ * same layout as struct ece391_procinfo in syscalls/ece391syscall.h
+ */
+typedef struct proc_info {
+    int32_t pid;
+    int32_t parent_id;
+    int32_t terminal;
+    int32_t sched_class;
+    uint8_t name[PROC_NAME_LEN];
+    proc_stats_t stats;
+} proc_info_t;
+
+// copy the running processes' records into buf, returns how many were copied
+int32_t get_proc_infos(proc_info_t* buf, int32_t count);
+
+// whether a running process was loaded from the program in inode
+int exec_inode_in_use(uint32_t inode);
+
 // pidToPCB
 uint32_t* pidToPCB(uint8_t pid);
 
@@ -1,5 +1,7 @@
 #include "pit.h"
 
+#include "scheduler.h"
+
 volatile int counter;
 void _timer_handler();
 
@@ -25,14 +27,18 @@ void init_timer(int freq) {
  *   DESCRIPTION: handler for PIT which is passed into assembly linkage in idt_linkage.S
  *                executed in a critical section
  *   INPUTS: none
- *   OUTPUTS: the scheduler will be called every time interval given by frequency passed into init
+ *   OUTPUTS: the scheduler will be called every time interval given by frequency passed into init,
+ *            and the rows of the screen changed since the last tick are flushed
  *   RETURN VALUE: none
- *   SIDE EFFECTS: other interrupt handlers cannot run simultaneously because of critical section
+ *   SIDE EFFECTS: other interrupt handlers cannot run simultaneously because of critical section,
+ *                 may switch to another terminal's process before returning
  */
 void _timer_handler() {
     cli();
-    counter = (counter + 1) % 3; // increment counter
-    // TODO: call scheduler program, implement scheduling
+    counter++; // count ticks
+    // send eoi before scheduling, the next process may not come back through here for a while
     send_eoi(TIMER_IRQ_NUM); // send eoi to IRQ0, port that timer chip occupies on PIC
+    flush_screen(); // output that went out without a flush, like putc's
+    schedule();
     sti();
 }
@@ -4,12 +4,15 @@
 #include "types.h"
 #include "filesystem.h"
 #include "pcb.h"
+#include "scheduler.h"
 
 // local functions
 void _rtc_interrupt_handler();
 
 // local variables
-uint8_t flag = 1;
+static volatile uint32_t rtc_ticks = 0;  // interrupts since boot, at RTC_MAX_FREQ
+static uint32_t rtc_next_wake = 0;       // tick at which the earliest sleeping reader is due
+static wait_queue_t rtc_queue;           // processes waiting in rtc_read
 
 // rtc operations table
 const fileops_table_t rtcOps_table = {
@@ -22,7 +25,7 @@ const fileops_table_t rtcOps_table = {
  * init_rtc
  *   DESCRIPTION: initializes rtc
  *   INPUTS: none
- *   OUTPUTS: rtc is initialized and starts generating interrupt with default frequency 1024 Hz
+ *   OUTPUTS: rtc is initialized and starts generating interrupts at RTC_MAX_FREQ
  *   RETURN VALUE: none
  *   SIDE EFFECTS: none
  */
@@ -32,6 +35,11 @@ void init_rtc() {
     char prev = inb(RTC_DATA_PORT);    // read the current value of register B
     outb(REGISTER_B, RTC_INDEX_PORT);  // set the index again (a read will reset the index to register D)
     outb(prev | 0x40, RTC_DATA_PORT);  // write the previous value ORed with 0x40. This turns on bit 6 of register B
+    // readers get their own rates from rtc_read, so the chip always runs at the fastest one
+    outb(REGISTER_A, RTC_INDEX_PORT);                  // set index to register A, disable NMI
+    prev = inb(RTC_DATA_PORT);                         // get initial value of register A
+    outb(REGISTER_A, RTC_INDEX_PORT);                  // reset index to A
+    outb((prev & 0xF0) | RTC_MAX_RATE, RTC_DATA_PORT); // write only our rate to A. Note, rate is the bottom 4 bits.
     enable_irq(RTC_IRQ_NUM);           // enable rtc
 }
 
@@ -52,82 +60,79 @@ void _rtc_interrupt_handler() {
     outb(REGISTER_C, RTC_INDEX_PORT);  // select register C
     (void)inb(RTC_DATA_PORT);          // just throw away contents
     send_eoi(RTC_IRQ_NUM);             // send eoi to IRQ8, the port rtc occupies on PIC
-    flag = 1;
+    rtc_ticks++;
+    // only wake the readers once one of them is due
+    if ((int32_t)(rtc_ticks - rtc_next_wake) >= 0) {
+        rtc_next_wake = rtc_ticks + RTC_MAX_FREQ;
+        wake_up(&rtc_queue);
+    }
     sti();  // end critical section
 }
 
 /*
  * rtc_read
- *   DESCRIPTION: blocks until next rtc interrupt
+ *   DESCRIPTION: blocks until the fd's next virtual rtc interrupt. each
+ *                fd ticks at its own frequency on top of the hardware
+ *                rtc, and ticks are spaced from the last one rather than
+ *                from the call so the rate stays exact
  *   INPUTS: fd - file descriptor
  *           buf - buffer to read from (ignored)
  *           nbytes - bytes to be read
  *   OUTPUTS: blocks the program until next rtc interrupt has occured
  *   RETURN VALUE: 0 for successful operation
- *   SIDE EFFECTS: none
+ *   SIDE EFFECTS: the process sleeps, other terminals run meanwhile
  */
 int32_t rtc_read(int32_t fd, void* buf, int32_t nbytes) {
-    flag = 0; // set the flag to 0
-    while (flag == 0) { // wait until the flag is no longer 0, which can only be changed by keyboard interrupt handler
+    file_descriptor_t* file_desc = &curr_pcb->file_desc[fd];
+    cli();
+    file_desc->rtc_deadline += file_desc->rtc_interval;
+    // a reader that fell more than a tick behind starts over instead of catching up in a burst
+    if ((int32_t)(rtc_ticks - file_desc->rtc_deadline) > 0) {
+        file_desc->rtc_deadline = rtc_ticks + file_desc->rtc_interval;
+    }
+    while ((int32_t)(rtc_ticks - file_desc->rtc_deadline) < 0) {
+        if ((int32_t)(file_desc->rtc_deadline - rtc_next_wake) < 0) {
+            rtc_next_wake = file_desc->rtc_deadline;
+        }
+        sleep_on(&rtc_queue);
     };
+    sti();
     return 0;
 }
 
 /*
  * rtc_write
- *   DESCRIPTION: change the frequency of rtc
+ *   DESCRIPTION: change the frequency of the fd's virtual rtc
  *   INPUTS: fd - file descriptor
  *           buf - buffer to read from
  *           nbytes - bytes to be read
- *   OUTPUTS: frequecy of rtc changed based on input read from buf
+ *   OUTPUTS: frequecy of the fd's rtc changed based on input read from buf
  *   RETURN VALUE: 0 for successful operation
  *                 -1 if frequency is not power of 2, or too fast, or too slow
- *   SIDE EFFECTS: none
+ *   SIDE EFFECTS: the next tick comes one new period after the call
  */
 int32_t rtc_write(int32_t fd, const void* buf, int32_t nbytes) {
+    if (buf == NULL) {
+        return -1;
+    }
     int frequency = *((int*)buf);            // get frequency from terminal buffer
     if ((frequency & (frequency - 1)) != 0)  // not power of 2 is bad input
         return -1;
-
-    // use the formula calculate rate to set from frequency input
-    // frequency = 32768 >> (rate-1)
-    //           = 2^(15-rate+1)
-    //           = 2^(16-rate)
-    //           = 2^16 / 2^rate
-    // 2^rate = 65536 / frequency
-    // which means rate is the index of 1 in binary (65536/frequency)
-    int twoPowRate = (65536 / frequency); 
-    uint8_t rate = 0;
-    while (twoPowRate != 0) {
-        // base case, we have reached twoPowRate == 1
-        // rate is the index of that 1 in binary
-        if (twoPowRate == 1) {
-            break;
-        }
-        // for each iteration, shift twoPowRate by 1 bit and increment rate
-        twoPowRate >>= 1;
-        rate += 1;
-    }
-    if (rate < 6 || rate > 15)  // rate greater than 1024 Hz or invalid
+    if (frequency < RTC_MIN_FREQ || frequency > RTC_MAX_FREQ)  // too slow or too fast
         return -1;
 
     cli();
-    outb(REGISTER_A, RTC_INDEX_PORT);           // set index to register A, disable NMI
-    char prev = inb(RTC_DATA_PORT);             // get initial value of register A
-    outb(REGISTER_A, RTC_INDEX_PORT);           // reset index to A
-    outb((prev & 0xF0) | rate, RTC_DATA_PORT);  // write only our rate to A. Note, rate is the bottom 4 bits.
-
-    outb(REGISTER_A, RTC_INDEX_PORT);  // set index to register A, disable NMI
-    prev = inb(RTC_DATA_PORT);         // get initial value of register A
+    curr_pcb->file_desc[fd].rtc_interval = RTC_MAX_FREQ / frequency;
+    curr_pcb->file_desc[fd].rtc_deadline = rtc_ticks;
     sti();
     return 0;
 }
 
 /*
  * rtc_open
- *   DESCRIPTION: open the rtc device and changes the frequency to the default of 2 Hz
+ *   DESCRIPTION: open the rtc device with the default frequency of 2 Hz
  *   INPUTS: filename - name of the device file
- *   OUTPUTS: frequency of rtc changed to 2 Hz, rtc opened in PCB
+ *   OUTPUTS: rtc opened in PCB with its virtual frequency at 2 Hz
  *   RETURN VALUE: fd for successful operation, 
  *                 -1 for full PCB
  *   SIDE EFFECTS: none
@@ -141,7 +146,7 @@ int32_t rtc_open(const uint8_t* filename) {
     dentry_t dir_entry;
     // check for empty space in PCB
     // start from 2 since stdin and stdout always take TEST_PCB[0] and TEST_PCB[1]
-    for (fd = 2; fd < PCB_SIZE; fd++) {
+    for (fd = 2; fd < FD_SIZE; fd++) {
         // if rtc was already opened, use that fd index
         if (curr_pcb->file_desc[fd].fileops_table_ptr == (int32_t *)(&rtcOps_table))
             return fd;
@@ -155,16 +160,8 @@ int32_t rtc_open(const uint8_t* filename) {
                 curr_pcb->file_desc[fd].fileops_table_ptr = (int32_t *)(&rtcOps_table);
                 curr_pcb->file_desc[fd].file_pos = 0;
                 curr_pcb->file_desc[fd].flags = 1;
-
-                uint8_t rate = 0xF;  // 0xF corresponds to 2Hz according to ds12887 reference sheet
-                cli();
-
-                outb(REGISTER_A, RTC_INDEX_PORT);           // set index to register A, disable NMI
-                char prev = inb(RTC_DATA_PORT);             // get initial value of register A
-                outb(REGISTER_A, RTC_INDEX_PORT);           // reset index to A
-                outb((prev & 0xF0) | rate, RTC_DATA_PORT);  // write only our rate to A. Note, rate is the bottom 4 bits.
-
-                sti();
+                curr_pcb->file_desc[fd].rtc_interval = RTC_MAX_FREQ / RTC_DEFAULT_FREQ;
+                curr_pcb->file_desc[fd].rtc_deadline = rtc_ticks;
                 // return fd just made
                 return fd;
             }
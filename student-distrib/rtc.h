@@ -11,16 +11,21 @@
 #define REGISTER_B  0x8B
 #define REGISTER_C  0x0C
 
+#define RTC_MAX_FREQ 1024    // hardware rtc frequency, the fastest a reader can ask for
+#define RTC_MAX_RATE 6       // rate bits in register A for RTC_MAX_FREQ
+#define RTC_MIN_FREQ 2       // slowest frequency a reader can ask for
+#define RTC_DEFAULT_FREQ 2   // frequency of a freshly opened rtc
+
 // initializes rtc
 void init_rtc();
 
-// blocks until next rtc interrupt
+// blocks until the fd's next virtual rtc interrupt
 int32_t rtc_read(int32_t fd, void* buf, int32_t nbytes);
 
-// change the frequency of rtc
+// change the frequency of the fd's virtual rtc
 int32_t rtc_write(int32_t fd, const void* buf, int32_t nbytes);
 
-// open the rtc device and changes the frequency to the default of 2 Hz
+// open the rtc device with the default frequency of 2 Hz
 int32_t rtc_open(const uint8_t* filename);
 
 // does nothing
@@ -0,0 +1,243 @@
+// scheduler.c - round robin scheduling of the terminals' processes, driven by the PIT
+
+#include "scheduler.h"
+
+#include "lib.h"
+#include "paging.h"
+#include "pcb.h"
+#include "syscall.h"
+#include "terminals.h"
+#include "x86_desc.h"
+
+static void run_next_terminal();
+static int next_terminal();
+static int find_runnable(int interactive);
+static int terminal_class(int terminal_id);
+static void start_terminal_shell();
+
+// time slice of each class in PIT ticks, the auto class is never looked up
+static int sched_quantum[SCHED_NUM_CLASSES] = {0, SCHED_INTERACTIVE_QUANTUM, SCHED_BATCH_QUANTUM};
+// ticks left in the running terminal's time slice
+static int slice_ticks = 0;
+
+/*
+ * schedule
+ *   DESCRIPTION: called on every PIT tick. charges the tick to the running
+ *                process, then once the running terminal's time slice is
+ *                used up, or right away if its process is asleep, gives
+ *                the CPU to the next terminal's process
+ *   INPUTS: none
+ *   OUTPUTS: none
+ *   RETURN VALUE: none (returns once this terminal is scheduled again)
+ *   SIDE EFFECTS: see run_next_terminal, must be called with interrupts off
+ */
+void schedule() {
+    // a terminal in the middle of starting its shell has nothing to come back to yet
+    if (!terminal_arr[curr_terminal].initialized) {
+        return;
+    }
+    // a sleeping process is only waiting in sleep_on, the tick was idle
+    if (!terminal_arr[curr_terminal].sleeping) {
+        curr_pcb->stats.ticks++;
+    }
+    if (--slice_ticks > 0 && !terminal_arr[curr_terminal].sleeping) {
+        return;
+    }
+    run_next_terminal();
+}
+
+/*
+ * sleep_on
+ *   DESCRIPTION: puts the running process on the queue and runs other
+ *                terminals until wake_up is called on it. the core is
+ *                halted while no terminal can run. the caller checks its
+ *                condition again after waking, with interrupts still off
+ *                so a wake_up can't slip in between the check and the sleep
+ *   INPUTS: queue -- queue to wait on
+ *   OUTPUTS: none
+ *   RETURN VALUE: none
+ *   SIDE EFFECTS: other terminals run in the meantime,
+ *                 must be called with interrupts off
+ */
+void sleep_on(wait_queue_t* queue) {
+    terminal_t* terminal = &terminal_arr[curr_terminal];
+    queue->waiters |= 1 << curr_terminal;
+    terminal->sleeping = 1;
+    while (terminal->sleeping) {
+        run_next_terminal();
+        // back here either woken up or because nothing else can run, wait for an interrupt if so
+        if (terminal->sleeping) {
+            asm volatile("sti; hlt; cli" : : : "memory");
+        }
+    }
+}
+
+/*
+ * wake_up
+ *   DESCRIPTION: makes every process waiting on the queue runnable, they
+ *                run again when their terminal next comes up
+ *   INPUTS: queue -- queue to wake
+ *   OUTPUTS: none
+ *   RETURN VALUE: none
+ *   SIDE EFFECTS: empties the queue, safe to call from interrupt handlers
+ */
+void wake_up(wait_queue_t* queue) {
+    int i;
+    for (i = 0; i < NUM_TERMINALS; i++) {
+        if (queue->waiters & (1 << i)) {
+            terminal_arr[i].sleeping = 0;
+        }
+    }
+    queue->waiters = 0;
+}
+
+/*
+ * run_next_terminal
+ *   DESCRIPTION: gives the CPU to the active process of the terminal
+ *                next_terminal picks and starts its time slice. the running
+ *                process's kernel context, pcb and tss.esp0 are saved in its
+ *                terminal, and the next one's are loaded along with its
+ *                user program pages. a terminal that is being shown for
+ *                the first time gets its shell started
+ *   INPUTS: none
+ *   OUTPUTS: none
+ *   RETURN VALUE: none (returns once this terminal is scheduled again)
+ *   SIDE EFFECTS: changes curr_terminal, curr_pcb, tss and paging,
+ *                 must be called with interrupts off
+ */
+static void run_next_terminal() {
+    int prev_terminal = curr_terminal;
+    int target_terminal = next_terminal();
+    slice_ticks = sched_quantum[terminal_class(target_terminal)];
+    if (target_terminal == prev_terminal) {
+        return;
+    }
+    // save what the running terminal needs to resume
+    terminal_arr[prev_terminal].curr_pcb = curr_pcb;
+    terminal_arr[prev_terminal].esp0 = tss.esp0;
+    curr_terminal = target_terminal;
+    set_screen_terminal(target_terminal);
+    if (!terminal_arr[target_terminal].initialized) {
+        // nothing to resume on the new terminal, start its shell on the rest of this stack
+        launch_context(&terminal_arr[prev_terminal].esp, &start_terminal_shell);
+        return;
+    }
+    curr_pcb = terminal_arr[target_terminal].curr_pcb;
+    tss.esp0 = terminal_arr[target_terminal].esp0;
+    tss.ss0 = KERNEL_DS;
+    map_process_pages(curr_pcb->process_id);
+    switch_context(&terminal_arr[prev_terminal].esp, terminal_arr[target_terminal].esp);
+}
+
+/*
+ * change_sched_class
+ *   DESCRIPTION: puts the running process in a scheduling class, its
+ *                children start out in the same class
+ *   INPUTS: sched_class -- one of SCHED_CLASS_*
+ *           quantum -- new time slice for the class in PIT ticks,
+ *                      0 keeps the current one (must be 0 for auto)
+ *   OUTPUTS: none
+ *   RETURN VALUE: 0 for success, -1 for a bad class or quantum
+ *   SIDE EFFECTS: the time slice applies to every process in the class
+ */
+int32_t change_sched_class(int32_t sched_class, int32_t quantum) {
+    if (sched_class < 0 || sched_class >= SCHED_NUM_CLASSES || quantum < 0 || quantum > SCHED_MAX_QUANTUM) {
+        return -1;
+    }
+    if (sched_class == SCHED_CLASS_AUTO && quantum != 0) {
+        return -1;
+    }
+    if (quantum != 0) {
+        sched_quantum[sched_class] = quantum;
+    }
+    curr_pcb->sched_class = sched_class;
+    return 0;
+}
+
+/*
+ * next_terminal
+ *   DESCRIPTION: picks the terminal to run after curr_terminal. interactive
+ *                and batch terminals take turns, so an interactive process
+ *                never waits more than one batch slice, and each class is
+ *                round robin within itself
+ *   INPUTS: none
+ *   OUTPUTS: none
+ *   RETURN VALUE: id of the next terminal, curr_terminal if no other can run
+ *   SIDE EFFECTS: none
+ */
+static int next_terminal() {
+    int interactive = terminal_class(curr_terminal) != SCHED_CLASS_INTERACTIVE;
+    int terminal_id = find_runnable(interactive);
+    // fall back to the other class if this one has nothing to run
+    if (terminal_id == -1) {
+        terminal_id = find_runnable(!interactive);
+    }
+    return terminal_id == -1 ? curr_terminal : terminal_id;
+}
+
+/*
+ * find_runnable
+ *   DESCRIPTION: looks for the next terminal after curr_terminal, wrapping
+ *                around to it, that can run and is in the given class.
+ *                every terminal with a shell that isn't asleep can run, the
+ *                one on screen can also run without a shell so that one
+ *                gets started
+ *   INPUTS: interactive -- 1 to look for an interactive terminal, 0 for batch
+ *   OUTPUTS: none
+ *   RETURN VALUE: id of the terminal, -1 if there is none
+ *   SIDE EFFECTS: none
+ */
+static int find_runnable(int interactive) {
+    int i, terminal_id;
+    for (i = 1; i <= NUM_TERMINALS; i++) {
+        terminal_id = (curr_terminal + i) % NUM_TERMINALS;
+        if ((terminal_class(terminal_id) == SCHED_CLASS_INTERACTIVE) != interactive) {
+            continue;
+        }
+        if (terminal_arr[terminal_id].initialized) {
+            if (terminal_arr[terminal_id].sleeping) {
+                continue;
+            }
+            return terminal_id;
+        }
+        // only start a shell if there is a pid and the memory left for it, a
+        // terminal that can't start its shell would never give up the CPU
+        if (terminal_id == curr_foreground_terminal && process_memory_available(find_avail_pid())) {
+            return terminal_id;
+        }
+    }
+    return -1;
+}
+
+/*
+ * terminal_class
+ *   DESCRIPTION: finds the class the terminal's active process runs in,
+ *                resolving the auto class by whether the terminal is on screen
+ *   INPUTS: terminal_id -- terminal to look at
+ *   OUTPUTS: none
+ *   RETURN VALUE: SCHED_CLASS_INTERACTIVE or SCHED_CLASS_BATCH
+ *   SIDE EFFECTS: none
+ */
+static int terminal_class(int terminal_id) {
+    pcb_t* pcb = terminal_id == curr_terminal ? curr_pcb : terminal_arr[terminal_id].curr_pcb;
+    if (terminal_arr[terminal_id].initialized && pcb->sched_class != SCHED_CLASS_AUTO) {
+        return pcb->sched_class;
+    }
+    return terminal_id == curr_foreground_terminal ? SCHED_CLASS_INTERACTIVE : SCHED_CLASS_BATCH;
+}
+
+/*
+ * start_terminal_shell
+ *   DESCRIPTION: runs the base shell of curr_terminal, entered through
+ *                launch_context the first time the terminal is scheduled
+ *   INPUTS: none
+ *   OUTPUTS: none
+ *   RETURN VALUE: none (never returns)
+ *   SIDE EFFECTS: execute sets up the terminal's first process
+ */
+static void start_terminal_shell() {
+    // execute only comes back if the shell couldn't be started, keep trying like halt does
+    while (1) {
+        execute((uint8_t*)"shell");
+    }
+}
@@ -0,0 +1,38 @@
+#ifndef _SCHEDULER_H
+#define _SCHEDULER_H
+
+#include "types.h"
+
+#define SCHED_CLASS_AUTO 0         // interactive on the terminal on screen, batch otherwise
+#define SCHED_CLASS_INTERACTIVE 1  // runs between every other slice
+#define SCHED_CLASS_BATCH 2        // shares the remaining slices round robin
+#define SCHED_NUM_CLASSES 3        // number of scheduling classes, including auto
+
+#define SCHED_INTERACTIVE_QUANTUM 4  // default interactive time slice in PIT ticks
+#define SCHED_BATCH_QUANTUM 2        // default batch time slice in PIT ticks
+#define SCHED_MAX_QUANTUM 100        // longest time slice a class can be given
+
+// processes waiting for an event, one bit per terminal whose active process waits
+typedef struct wait_queue {
+    uint32_t waiters;
+} wait_queue_t;
+
+// switches to the next terminal's process, called on every PIT interrupt
+void schedule();
+
+// blocks the running process until wake_up is called on the queue
+void sleep_on(wait_queue_t* queue);
+
+// makes every process waiting on the queue runnable again
+void wake_up(wait_queue_t* queue);
+
+// sets the calling process's scheduling class and optionally that class's time slice
+int32_t change_sched_class(int32_t sched_class, int32_t quantum);
+
+// assembly - save the current kernel context and resume the one saved at next_esp
+extern void switch_context(uint32_t* save_esp, uint32_t next_esp);
+
+// assembly - save the current kernel context and call entry on the same stack
+extern void launch_context(uint32_t* save_esp, void (*entry)(void));
+
+#endif
@@ -0,0 +1,122 @@
+// scrollback.c - lines that scrolled off each terminal's screen, and viewing them with Shift+PgUp/PgDn
+
+#include "scrollback.h"
+
+#include "lib.h"
+#include "terminals.h"
+
+// ring of lines per terminal, characters only: everything the kernel prints has attribute ATTRIB
+static uint8_t history[NUM_TERMINALS][SCROLLBACK_LINES][NUM_COLS];
+static int history_head[NUM_TERMINALS];   // slot the next line goes in
+static int history_count[NUM_TERMINALS];  // lines kept, up to SCROLLBACK_LINES
+
+// lines the foreground terminal's view is moved up into the history, 0 for the live screen
+static int view_lines = 0;
+
+static void draw_view();
+
+/*
+ * scrollback_push
+ *   DESCRIPTION: packs a row of screen cells into the terminal's history,
+ *                overwriting the oldest line once the ring is full. one
+ *                byte per cell, less work than the scroll that drops the row
+ *   INPUTS: terminal_id -- terminal the row belongs to
+ *           row -- NUM_COLS cells of the row leaving the top of the screen
+ *   OUTPUTS: none
+ *   RETURN VALUE: none
+ *   SIDE EFFECTS: a view into the history stays on the same lines
+ */
+void scrollback_push(int terminal_id, const uint16_t* row) {
+    uint8_t* line = history[terminal_id][history_head[terminal_id]];
+    int x;
+    for (x = 0; x < NUM_COLS; x++) {
+        line[x] = (uint8_t)row[x];
+    }
+    history_head[terminal_id] = (history_head[terminal_id] + 1) % SCROLLBACK_LINES;
+    if (history_count[terminal_id] < SCROLLBACK_LINES) {
+        history_count[terminal_id]++;
+    }
+    if (view_lines != 0 && terminal_id == curr_foreground_terminal) {
+        // the screen under the view moved up a line, keep looking at the same text
+        view_lines = min(view_lines + 1, history_count[terminal_id]);
+    }
+}
+
+/*
+ * scrollback_scroll
+ *   DESCRIPTION: moves the foreground terminal's view up into its history
+ *                or back down, and redraws the screen from it. output
+ *                keeps going to the back buffer meanwhile and shows up
+ *                once the view is back at the bottom
+ *   INPUTS: lines -- lines to move up, negative to move down
+ *   OUTPUTS: the view on the screen
+ *   RETURN VALUE: none
+ *   SIDE EFFECTS: none
+ */
+void scrollback_scroll(int lines) {
+    uint32_t flags;
+    cli_and_save(flags);
+    view_lines = max(0, min(view_lines + lines, history_count[curr_foreground_terminal]));
+    // puts the screen at the start of video memory, and draws all of it when the view is at the bottom
+    redraw_screen();
+    if (view_lines != 0) {
+        draw_view();
+    }
+    restore_flags(flags);
+}
+
+/*
+ * scrollback_end
+ *   DESCRIPTION: puts the foreground terminal's live screen back, for a
+ *                key press or a terminal switch
+ *   INPUTS: none
+ *   OUTPUTS: the live screen, if history was on display
+ *   RETURN VALUE: none
+ *   SIDE EFFECTS: none
+ */
+void scrollback_end() {
+    if (view_lines != 0) {
+        scrollback_scroll(-view_lines);
+    }
+}
+
+/*
+ * scrollback_viewing
+ *   DESCRIPTION: tells flush_screen to leave the screen alone
+ *   INPUTS: none
+ *   OUTPUTS: none
+ *   RETURN VALUE: 1 if history is on display, 0 if not
+ *   SIDE EFFECTS: none
+ */
+int scrollback_viewing() {
+    return view_lines != 0;
+}
+
+/*
+ * draw_view
+ *   DESCRIPTION: draws view_lines of history at the top of video memory,
+ *                followed by the top of the back buffer
+ *   INPUTS: none
+ *   OUTPUTS: the view on the screen
+ *   RETURN VALUE: none
+ *   SIDE EFFECTS: must be called with interrupts off
+ */
+static void draw_view() {
+    int terminal_id = curr_foreground_terminal;
+    int oldest = (history_head[terminal_id] - history_count[terminal_id] + SCROLLBACK_LINES) % SCROLLBACK_LINES;
+    int first = history_count[terminal_id] - view_lines;  // history line at the top of the screen
+    uint16_t* screen = (uint16_t*)VIDEO;
+    uint16_t* back_buf = (uint16_t*)get_page_addr_from_terminal_id(terminal_id);
+    uint8_t* line;
+    int x, y;
+    for (y = 0; y < NUM_ROWS; y++) {
+        if (first + y < history_count[terminal_id]) {
+            line = history[terminal_id][(oldest + first + y) % SCROLLBACK_LINES];
+            for (x = 0; x < NUM_COLS; x++) {
+                screen[y * NUM_COLS + x] = (ATTRIB << 8) | line[x];
+            }
+        } else {
+            memcpy_dword(screen + y * NUM_COLS, back_buf + (first + y - history_count[terminal_id]) * NUM_COLS, (NUM_COLS << 1) / BYTES_PER_DWORD);
+        }
+    }
+}
@@ -0,0 +1,22 @@
+#ifndef _SCROLLBACK_H
+#define _SCROLLBACK_H
+
+#include "types.h"
+#include "lib.h"
+
+#define SCROLLBACK_LINES 2048          // lines of history kept for each terminal
+#define SCROLLBACK_PAGE (NUM_ROWS / 2) // lines moved by one Shift+PgUp or Shift+PgDn
+
+// saves a row that is about to scroll off the top of a terminal's screen
+void scrollback_push(int terminal_id, const uint16_t* row);
+
+// moves the foreground terminal's view lines up into the history, negative lines moves it back down
+void scrollback_scroll(int lines);
+
+// returns the foreground terminal to its live screen if it is showing history
+void scrollback_end();
+
+// whether the screen is showing history, output isn't flushed while it is
+int scrollback_viewing();
+
+#endif
@@ -1,46 +1,73 @@
 #include "syscall.h"
 
 #include "filesystem.h"
+#include "kmalloc.h"
 #include "lib.h"
 #include "paging.h"
 #include "pcb.h"
 #include "rtc.h"
+#include "scheduler.h"
 #include "terminals.h"
 #include "types.h"
 #include "x86_desc.h"
 
 // global variables
-char arg_buf[MAX_BUF_SIZE];
 
 // local functions
 int parseCmd(uint8_t *cmd, char cmd_buf[MAX_BUF_SIZE], char arg_buf[MAX_BUF_SIZE]);
 int checkFd(int fd);
 uint32_t *pidToPCB(uint8_t pid);
 uint32_t *pidToESP0(uint8_t pid);
+static void write_msr(uint32_t msr, uint32_t value);
+static int user_range_ok(uint32_t addr, uint32_t len);
+
+/*
+ * syscall_init
+ *   DESCRIPTION: maps the system call stub page into every process at
+ *                VSYSCALL_ADDR. if the CPU has SYSENTER, the MSRs are
+ *                pointed at sysenter_handler and the SYSENTER stub is
+ *                mapped, otherwise the int $0x80 one
+ *   INPUTS: none
+ *   OUTPUTS: none
+ *   RETURN VALUE: none
+ *   SIDE EFFECTS: must run after paging_init, before any program starts
+ */
+void syscall_init() {
+    uint32_t eax, ebx, ecx, edx;
+    uint8_t *stub_page = vsyscall_int80_page;
+    asm volatile("cpuid"
+                 : "=a"(eax), "=b"(ebx), "=c"(ecx), "=d"(edx)
+                 : "a"(1));
+    if (edx & CPUID_SEP) {
+        // SYSEXIT takes the user cs and ss from the two descriptors after KERNEL_CS and KERNEL_DS, which USER_CS and USER_DS are
+        write_msr(MSR_SYSENTER_CS, KERNEL_CS);
+        // the entry loads the kernel stack of whatever process is running from tss.esp0
+        write_msr(MSR_SYSENTER_ESP, (uint32_t)&tss.esp0);
+        write_msr(MSR_SYSENTER_EIP, (uint32_t)sysenter_handler);
+        stub_page = vsyscall_sysenter_page;
+    }
+    // the vidmap page table is shared by every process
+    vidmap_page_table[(VSYSCALL_ADDR >> VIDMAP_PTE_IDX_POS) & (ENTRIES - 1)] = (uint32_t)stub_page | VSYSCALL_PTE;
+}
 
 /*
  * syscall_open
  *   DESCRIPTION: logic for system call open
- *   INPUTS: arguments in registers from eax to edx
+ *   INPUTS: filename -- name of the file to open
  *   OUTPUTS: none
  *   RETURN VALUE: none
  *   SIDE EFFECTS: none
  */
-int syscall_open() {
-    unsigned int call_number, arg1, arg2, arg3;
-    asm volatile(""
-                 : "=a"(call_number), "=b"(arg1), "=c"(arg2), "=d"(arg3));  // retrieve register values
-    // printf("eax: %u, ebx: %u, ecx: %u, edx: %u\n", call_number, arg1, arg2, arg3);
-    sti();  // enable IF since int $0x80 turns it off by default
+int32_t syscall_open(const uint8_t *filename) {
     int fd;
-    if (strlen((int8_t *)arg1) == 1 && strncmp((int8_t *)arg1, ".", 1) == 0) {
+    if (strlen((int8_t *)filename) == 1 && strncmp((int8_t *)filename, ".", 1) == 0) {
         // "." is the only directory, calling dir_open
-        fd = dir_open((uint8_t *)arg1);
-    } else if (strlen((int8_t *)arg1) == 3 && strncmp((int8_t *)arg1, "rtc", 3) == 0) {
-        fd = rtc_open((uint8_t *)arg1);
+        fd = dir_open(filename);
+    } else if (strlen((int8_t *)filename) == 3 && strncmp((int8_t *)filename, "rtc", 3) == 0) {
+        fd = rtc_open(filename);
     } else {
         // everything else is a regular file
-        fd = file_open((uint8_t *)arg1);
+        fd = file_open(filename);
     }
     return fd;
 }
@@ -48,20 +75,15 @@ int syscall_open() {
 /*
  * syscall_close
  *   DESCRIPTION: logic for system call close
- *   INPUTS: arguments in registers from eax to edx
+ *   INPUTS: fd -- file descriptor to close
  *   OUTPUTS: none
  *   RETURN VALUE: none
  *   SIDE EFFECTS: none
  */
-int syscall_close() {
-    unsigned int call_number, arg1, arg2, arg3;
-    asm volatile(""
-                 : "=a"(call_number), "=b"(arg1), "=c"(arg2), "=d"(arg3));  // retrieve register values
-    // printf("eax: %u, ebx: %u, ecx: %u, edx: %u\n", call_number, arg1, arg2, arg3);
-    sti();  // enable IF since int $0x80 turns it off by default
-    if (checkFd(arg1) == 0) {
+int32_t syscall_close(int32_t fd) {
+    if (checkFd(fd) == 0) {
         // valid fd, run close function in fileops_table_t
-        return ((fileops_table_t *)curr_pcb->file_desc[arg1].fileops_table_ptr)->fd_close((int32_t)arg1);
+        return ((fileops_table_t *)curr_pcb->file_desc[fd].fileops_table_ptr)->fd_close(fd);
     } else {
         // invalid fd
         return -1;
@@ -73,20 +95,22 @@ int syscall_close() {
 /*
  * syscall_read
  *   DESCRIPTION: logic for system call read
- *   INPUTS: arguments in registers from eax to edx
+ *   INPUTS: fd -- file descriptor to read from
+ *           buf -- buffer to read into
+ *           nbytes -- number of bytes to read
  *   OUTPUTS: none
  *   RETURN VALUE: none
  *   SIDE EFFECTS: none
  */
-int syscall_read() {
-    unsigned int call_number, arg1, arg2, arg3;
-    asm volatile(""
-                 : "=a"(call_number), "=b"(arg1), "=c"(arg2), "=d"(arg3));  // retrieve register values
-    // printf("eax: %u, ebx: %u, ecx: %u, edx: %u\n", call_number, arg1, arg2, arg3);
-    sti();  // enable IF since int $0x80 turns it off by default
-    if (checkFd(arg1) == 0) {
+int32_t syscall_read(int32_t fd, void *buf, int32_t nbytes) {
+    int32_t ret;
+    if (checkFd(fd) == 0) {
         // valid fd, run read function in fileops_table_t
-        return ((fileops_table_t *)((curr_pcb->file_desc[arg1].fileops_table_ptr)))->fd_read((int32_t)arg1, (void *)arg2, (int32_t)arg3);
+        ret = ((fileops_table_t *)((curr_pcb->file_desc[fd].fileops_table_ptr)))->fd_read(fd, buf, nbytes);
+        if (ret > 0) {
+            curr_pcb->stats.bytes_read += ret;
+        }
+        return ret;
     } else {
         // invalid fd
         return -1;
@@ -98,20 +122,22 @@ int syscall_read() {
 /*
  * syscall_write
  *   DESCRIPTION: logic for system call write
- *   INPUTS: arguments in registers from eax to edx
+ *   INPUTS: fd -- file descriptor to write to
+ *           buf -- buffer to write from
+ *           nbytes -- number of bytes to write
  *   OUTPUTS: none
  *   RETURN VALUE: none
  *   SIDE EFFECTS: none
  */
-int syscall_write() {
-    unsigned int call_number, arg1, arg2, arg3;
-    asm volatile(""
-                 : "=a"(call_number), "=b"(arg1), "=c"(arg2), "=d"(arg3));  // retrieve register values
-    // printf("eax: %u, ebx: %u, ecx: %u, edx: %u\n", call_number, arg1, arg2, arg3);
-    sti();  // enable IF since int $0x80 turns it off by default
-    if (checkFd(arg1) == 0) {
-        // valid fd, run close function in fileops_table_t
-        return ((fileops_table_t *)curr_pcb->file_desc[arg1].fileops_table_ptr)->fd_write((int32_t)arg1, (void *)arg2, (int32_t)arg3);
+int32_t syscall_write(int32_t fd, const void *buf, int32_t nbytes) {
+    int32_t ret;
+    if (checkFd(fd) == 0) {
+        // valid fd, run write function in fileops_table_t
+        ret = ((fileops_table_t *)curr_pcb->file_desc[fd].fileops_table_ptr)->fd_write(fd, (void *)buf, nbytes);
+        if (ret > 0) {
+            curr_pcb->stats.bytes_written += ret;
+        }
+        return ret;
     } else {
         // invalid fd
         return -1;
@@ -122,25 +148,19 @@ int syscall_write() {
 /*
  * syscall_halt
  *   DESCRIPTION: logic for system call halt
- *   INPUTS: arguments in registers from eax to edx
+ *   INPUTS: status -- exit status for the parent, 255 means an exception
  *   OUTPUTS: none
  *   RETURN VALUE: none
  *   SIDE EFFECTS: none
  */
-int syscall_halt() {
-    unsigned int call_number, arg1, arg2, arg3;
-    asm volatile(""
-                 : "=a"(call_number), "=b"(arg1), "=c"(arg2), "=d"(arg3));  // retrieve register values
-    // printf("eax: %u, ebx: %u, ecx: %u, edx: %u\n", call_number, arg1, arg2, arg3);
-    sti();  // enable IF since int $0x80 turns it off by default
+int32_t syscall_halt(uint8_t status) {
 
-    // arg1 = status
     int i;
     unsigned int retval;
-    if (arg1 == 255) {
+    if (status == 255) {
         retval = 256;
     } else {
-        retval = arg1;
+        retval = status;
     }
     // TODO: actual halt logic here
     // 1. Setup return value:
@@ -154,10 +174,18 @@ int syscall_halt() {
         }
     }
     // 3. Set currently-active-process to non-active
+    // the scheduler must not switch away while the process is half torn down
+    cli();
     curr_pcb->active = 0;
     uint32_t parent_esp = curr_pcb->saved_esp, parent_ebp = curr_pcb->saved_ebp;
     curr_pcb->saved_ebp = 0;
     curr_pcb->saved_esp = 0;
+    clear_mmap_pages(curr_pcb->process_id);
+    // the vidmap page goes with the process, the next one to get the pid hasn't asked for it
+    vidmap_page_table[curr_pcb->process_id] &= ~PAGE_PRESENT;
+    free_process_pages(curr_pcb->process_id);
+    kfree(curr_pcb->args);
+    curr_pcb->args = NULL;
     clear_pid(curr_pcb->process_id);
     // 4. Check if main shell
     if (curr_pcb->parent_id == -1) {
@@ -167,8 +195,8 @@ int syscall_halt() {
             execute((uint8_t *)"shell");
         }
     }
-    terminal_arr[curr_terminal].curr_pcb = curr_pcb;
     point_curr_pcb(curr_pcb->parent_id);
+    terminal_arr[curr_terminal].curr_pcb = curr_pcb;
     // 5. Not main shell handler (cntd.)
     //      a. Get parent process
     uint8_t parent_process = curr_pcb->process_id;
@@ -178,8 +206,7 @@ int syscall_halt() {
     tss.ss0 = KERNEL_DS;
     //      c. Unmap paging for current-process
     //      d. Map parent’s paging
-    page_directory[USER_PROG_IDX] = (USER_PROG_PA + (MB_OFFSET * parent_process)) | USER_PROG_PDE;
-    flush_tlb();
+    map_process_pages(parent_process);
     //      e. Set parent’s process as active
     curr_pcb->active = 1;
 
@@ -204,65 +231,75 @@ int syscall_halt() {
 /*
  * syscall_execute
  *   DESCRIPTION: logic for system call execute
- *   INPUTS: arguments in registers from eax to edx
+ *   INPUTS: command -- program name and arguments separated by a space
  *   OUTPUTS: none
  *   RETURN VALUE: none
  *   SIDE EFFECTS: none
  */
-int syscall_execute() {
-    unsigned int call_number, arg1, arg2, arg3;
-    asm volatile(""
-                 : "=a"(call_number), "=b"(arg1), "=c"(arg2), "=d"(arg3));  // retrieve register values
-    // printf("eax: %u, ebx: %u, ecx: %u, edx: %u\n", call_number, arg1, arg2, arg3);
-    sti();  // enable IF since int $0x80 turns it off by default
+int32_t syscall_execute(const uint8_t *command) {
 
     // 1. paging helpers (optional but recommended)
     //   - map virtual & physical memory
     //   - unmap virtual & physical memory
     // 2. parse cmd
     char cmd_buf[MAX_BUF_SIZE];
+    // the arguments stay with the new process for getargs
+    char *arg_buf = kmalloc(MAX_BUF_SIZE);
+    if (arg_buf == NULL) {
+        return -1;
+    }
     // make sure the buffer doesn't have any garbage that can affect the result
     memset(cmd_buf, '\0', MAX_BUF_SIZE);
     memset(arg_buf, '\0', MAX_BUF_SIZE);
-    if (parseCmd((uint8_t *)arg1, cmd_buf, arg_buf) != 0) {
+    if (parseCmd((uint8_t *)command, cmd_buf, arg_buf) != 0) {
+        kfree(arg_buf);
         return -1;
     }
     // 3. file checks
+    // keep the scheduler out until the new process is in user mode
+    cli();
     dentry_t trash_dir_entry;
     int trash_int;
     int status = exec_file_check((uint8_t *)cmd_buf, (uint32_t *)&trash_int, &trash_dir_entry);
     if (status == -1) {
+        kfree(arg_buf);
+        sti();
         return -1;
     }
     // 7. setup old stack & eip
     register uint32_t saved_ebp asm("ebp");
     register uint32_t saved_esp asm("esp");
     // 4. create new PCB
-    int available_pid = find_avail_pid();
-    if (available_pid == -1) {
-        // printf("No available space in PCB\n");
-        // point_curr_pcb(5);  // TODO: sus code here
+    int parentID = terminal_arr[curr_terminal].initialized == 0 ? -1 : curr_pcb->process_id;
+    int currID = create_pcb(parentID, saved_ebp, saved_esp);
+    if (currID == -1) {
+        // out of pids or out of memory for the kernel stack
+        kfree(arg_buf);
+        sti();
         return -1;
     }
-    int parentID = terminal_arr[curr_terminal].initialized == 0 ? -1 : curr_pcb->process_id;
     terminal_arr[curr_terminal].initialized = 1;
-    int currID = create_pcb(parentID, saved_ebp, saved_esp);
     point_curr_pcb(currID);
+    curr_pcb->args = arg_buf;
+    strncpy((int8_t *)curr_pcb->name, cmd_buf, PROC_NAME_LEN);
+    curr_pcb->terminal = curr_terminal;
+    terminal_arr[curr_terminal].curr_pcb = curr_pcb;
     // 5. setup memory/paging
     // 6. read exe data
     uint32_t prog_eip;
     status = load_program((uint8_t *)cmd_buf, &prog_eip);
     if (status == -1) {
+        sti();
         return -1;
     }
     curr_pcb->saved_eip = prog_eip;
     tss.esp0 = (uint32_t)pidToESP0(currID);
     tss.ss0 = KERNEL_DS;
     // 8. goto usermode
-    cli();
 
     // 43 = 0x2B = USER_DS
     // 35 = 0x23 = USER_CS
+    // IF is set in the pushed eflags so the PIT can preempt the program
     asm volatile(
         "                            \n\
             movw    $43, %%ax      \n\
@@ -274,6 +311,7 @@ int syscall_execute() {
             pushl   $43            \n\
             pushl   %%edx            \n\
             pushf                    \n\
+            orl     $0x200, (%%esp)  \n\
             pushl   $35            \n\
             pushl   %%ecx        \n\
             iret                     \n\
@@ -287,74 +325,158 @@ int syscall_execute() {
 /*
  * syscall_getargs
  *   DESCRIPTION: logic for system call getargs
- *   INPUTS: arguments in registers from eax to edx
+ *   INPUTS: buf -- buffer to copy the arguments into
+ *           nbytes -- size of buf
  *   OUTPUTS: none
  *   RETURN VALUE: none
  *   SIDE EFFECTS: none
  */
-int32_t syscall_getargs() {
-    unsigned int call_number, arg1, arg2, arg3;
-    asm volatile(""
-                 : "=a"(call_number), "=b"(arg1), "=c"(arg2), "=d"(arg3));  // retrieve register values
-    sti();                                                                  // enable IF since int $0x80 turns it off by default
-    // arg1 = uint8_t* buf
-    // arg2 = int32_t nbytes
-    if (arg1 == NULL || arg_buf == NULL || arg_buf[0] == '\0') {
+int32_t syscall_getargs(uint8_t *buf, int32_t nbytes) {
+    if (buf == NULL || curr_pcb->args == NULL || curr_pcb->args[0] == '\0') {
         // check if either buffer is null or if there are no arguments
         return -1;
     }
-    memcpy((void *)arg1, (void *)arg_buf, (uint32_t)arg2);  // copy arg_buf to buf
+    memcpy(buf, curr_pcb->args, (uint32_t)min(nbytes, MAX_BUF_SIZE));  // copy the arguments to buf
     return 0;
 }
 
 /*
  * syscall_vidmap
  *   DESCRIPTION: logic for system call vidmap
- *   INPUTS: arguments in registers from eax to edx
+ *   INPUTS: screen_start -- where to store the address video memory is mapped at
  *   OUTPUTS: none
  *   RETURN VALUE: none
  *   SIDE EFFECTS: none
  */
-int32_t syscall_vidmap() {
-    unsigned int call_number, arg1, arg2, arg3;
-    asm volatile(""
-                 : "=a"(call_number), "=b"(arg1), "=c"(arg2), "=d"(arg3));  // retrieve register values
-    sti();                                                                  // enable IF since int $0x80 turns it off by default
+int32_t syscall_vidmap(uint8_t **screen_start) {
     /* check that the address passed in is within the 4 MB user program page */
-    if (arg1 < USER_PROG_IDX * MB_OFFSET || arg1 >= VIDMAP_PDE_IDX * MB_OFFSET || (uint8_t **)arg1 == NULL) {
+    if ((uint32_t)screen_start < USER_PROG_IDX * MB_OFFSET || (uint32_t)screen_start >= VIDMAP_PDE_IDX * MB_OFFSET || screen_start == NULL) {
         return -1;
     }
-    /* map page in vidmap page table into the PA of video memory */
-    vidmap_page_table[curr_pcb->process_id] = (VIDMEM_PAGE_IDX * KB_OFFSET) | VIDMEM_PTE;
+    /* the program draws at the start of video memory, so that has to be what is on display */
+    redraw_screen();
+    /* map page in vidmap page table to video memory, or to the back buffer when the terminal isn't on screen */
+    map_vidmap_page(curr_pcb->process_id);
+    flush_tlb();
     /* get address of page just mapped to video memory */
     uint8_t *vidmap_addr = (uint8_t *)(((VIDMAP_PDE_IDX << VIDMAP_PDE_IDX_POS) | (curr_pcb->process_id << VIDMAP_PTE_IDX_POS)) & ZERO_ATTRIBUTE);
     /* map pointer from screen_start argument to that address */
-    *((uint8_t **)arg1) = vidmap_addr;
+    *screen_start = vidmap_addr;
     /* return 0 for success */
     return 0;
 }
 
+/*
+ * syscall_mmap
+ *   DESCRIPTION: logic for system call mmap, maps an open regular
+ *                file read only into the process's address space
+ *   INPUTS: fd -- open regular file to map
+ *           start -- where to store the address the file is mapped at
+ *   OUTPUTS: none
+ *   RETURN VALUE: length of the mapped file, -1 for failure
+ *   SIDE EFFECTS: none
+ */
+int32_t syscall_mmap(int32_t fd, uint8_t **start) {
+    /* the whole pointer has to be in user memory, not just its first byte */
+    if (!user_range_ok((uint32_t)start, sizeof(uint8_t *))) {
+        return -1;
+    }
+    /* only regular files live in data blocks that can be mapped */
+    if (checkFd(fd) != 0 || curr_pcb->file_desc[fd].fileops_table_ptr != (int32_t *)&fileops) {
+        return -1;
+    }
+    return mmap_file(curr_pcb->file_desc[fd].inode, start);
+}
+
+/*
+ * syscall_getdents
+ *   DESCRIPTION: logic for system call getdents, reads a batch of
+ *                directory records from an open directory
+ *   INPUTS: fd -- open directory
+ *           buf -- buffer for the records
+ *           nbytes -- size of buf
+ *   OUTPUTS: none
+ *   RETURN VALUE: number of bytes of records read, 0 at the end of
+ *                 the directory, -1 for failure
+ *   SIDE EFFECTS: none
+ */
+int32_t syscall_getdents(int32_t fd, void *buf, int32_t nbytes) {
+    if (!user_range_ok((uint32_t)buf, (uint32_t)nbytes)) {
+        return -1;
+    }
+    /* only the directory has records to read */
+    if (checkFd(fd) != 0 || curr_pcb->file_desc[fd].fileops_table_ptr != (int32_t *)&dirops) {
+        return -1;
+    }
+    return dir_getdents(fd, buf, nbytes);
+}
+
+/*
+ * syscall_set_sched_class
+ *   DESCRIPTION: logic for system call set_sched_class, moves the calling
+ *                process to another scheduling class
+ *   INPUTS: sched_class -- SCHED_AUTO, SCHED_INTERACTIVE or SCHED_BATCH
+ *           quantum -- new time slice of the class in PIT ticks, 0 to keep it
+ *   OUTPUTS: none
+ *   RETURN VALUE: 0 for success, -1 for failure
+ *   SIDE EFFECTS: a nonzero quantum changes the time slice of the whole class
+ */
+int32_t syscall_set_sched_class(int32_t sched_class, int32_t quantum) {
+    return change_sched_class(sched_class, quantum);
+}
+
+/*
+ * syscall_sbrk
+ *   DESCRIPTION: logic for system call sbrk, moves the end of the
+ *                calling process's heap
+ *   INPUTS: increment -- bytes to grow the heap by, negative to shrink it
+ *   OUTPUTS: none
+ *   RETURN VALUE: address of the old end of the heap, -1 for failure
+ *   SIDE EFFECTS: new heap pages read as zero when first touched
+ */
+int32_t syscall_sbrk(int32_t increment) {
+    return heap_sbrk(increment);
+}
+
+/*
+ * syscall_getprocs
+ *   DESCRIPTION: logic for system call getprocs, copies a record with
+ *                the CPU and I/O counters of every running process
+ *   INPUTS: buf -- buffer for the records
+ *           nbytes -- size of buf
+ *   OUTPUTS: none
+ *   RETURN VALUE: number of bytes of records copied, -1 for failure
+ *   SIDE EFFECTS: none
+ */
+int32_t syscall_getprocs(void *buf, int32_t nbytes) {
+    if (!user_range_ok((uint32_t)buf, (uint32_t)nbytes)) {
+        return -1;
+    }
+    return get_proc_infos((proc_info_t *)buf, nbytes / sizeof(proc_info_t)) * sizeof(proc_info_t);
+}
+
 /*
  * syscall_set_handler
  *   DESCRIPTION: logic for system call set_handler
- *   INPUTS: arguments in registers from eax to edx
+ *   INPUTS: signum -- signal to set the handler of
+ *           handler_address -- user function to run for the signal
  *   OUTPUTS: none
  *   RETURN VALUE: none
  *   SIDE EFFECTS: none
  */
-int32_t syscall_set_handler() {
+int32_t syscall_set_handler(int32_t signum, void *handler_address) {
     return -1;
 }
 
 /*
  * syscall_sigreturn
  *   DESCRIPTION: logic for system call sigreturn
- *   INPUTS: arguments in registers from eax to edx
+ *   INPUTS: none
  *   OUTPUTS: none
  *   RETURN VALUE: none
  *   SIDE EFFECTS: none
  */
-int32_t syscall_sigreturn() {
+int32_t syscall_sigreturn(void) {
     return -1;
 }
 
@@ -404,7 +526,7 @@ int parseCmd(uint8_t *cmd, char cmd_buf[MAX_BUF_SIZE], char arg_buf[MAX_BUF_SIZE
  *   SIDE EFFECTS: none
  */
 int checkFd(int fd) {
-    if (fd < 0 || fd >= PCB_SIZE || !curr_pcb->file_desc[fd].flags) {
+    if (fd < 0 || fd >= FD_SIZE || !curr_pcb->file_desc[fd].flags) {
         // invalid fd
         return -1;
     } else {
@@ -422,5 +544,41 @@ int checkFd(int fd) {
  *   SIDE EFFECTS: none
  */
 uint32_t *pidToESP0(uint8_t pid) {
-    return (uint32_t *)(KP_BOTTOM - KS_SIZE * (pid));
+    return (uint32_t *)(KSTACK_BASE + KS_SIZE * (pid + 1));
+}
+
+/*
+ * user_range_ok
+ *   DESCRIPTION: checks that a buffer passed in by a user program is all
+ *                in memory the program owns: its 4 MB program page, or
+ *                the part of its heap below the break
+ *   INPUTS: addr - start of the buffer
+ *           len - size of the buffer in bytes
+ *   OUTPUTS: none
+ *   RETURN VALUE: 1 if the kernel can use the buffer, 0 if not
+ *   SIDE EFFECTS: none
+ */
+static int user_range_ok(uint32_t addr, uint32_t len) {
+    uint32_t prog_start = USER_PROG_IDX * MB_OFFSET;
+    uint32_t heap_start = HEAP_PDE_IDX << VIDMAP_PDE_IDX_POS;
+    if (addr >= prog_start && addr - prog_start < MB_OFFSET && len <= MB_OFFSET - (addr - prog_start)) {
+        return 1;
+    }
+    return addr >= heap_start && addr - heap_start < curr_pcb->heap_size && len <= curr_pcb->heap_size - (addr - heap_start);
+}
+
+/*
+ * write_msr
+ *   DESCRIPTION: writes a model specific register
+ *   INPUTS: msr - register number
+ *           value - low 32 bits to write, the high 32 are zeroed
+ *   OUTPUTS: none
+ *   RETURN VALUE: none
+ *   SIDE EFFECTS: none
+ */
+static void write_msr(uint32_t msr, uint32_t value) {
+    asm volatile("wrmsr"
+                 :
+                 : "c"(msr), "a"(value), "d"(0)
+                 : "memory");
 }
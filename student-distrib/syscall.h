@@ -2,16 +2,42 @@
 #define _SYSCALL_H
 
 #include "types.h"
-#include "pcb.h"
 
-#define READ 3
-#define WRITE 4
-#define OPEN 5
-#define CLOSE 6
+// system call numbers, same as syscalls/ece391sysnum.h
+#define SYS_HALT 1
+#define SYS_EXECUTE 2
+#define SYS_READ 3
+#define SYS_WRITE 4
+#define SYS_OPEN 5
+#define SYS_CLOSE 6
+#define SYS_GETARGS 7
+#define SYS_VIDMAP 8
+#define SYS_SET_HANDLER 9
+#define SYS_SIGRETURN 10
+#define SYS_MMAP 11
+#define SYS_GETDENTS 12
+#define SYS_SET_SCHED_CLASS 13
+#define SYS_SBRK 14
+#define SYS_GETPROCS 15
 
 #define MAX_ARG_NUM 5
 #define MAX_BUF_SIZE 128
 
+// user address of the system call stub page, the last 4 kB page of the vidmap page table (VA 132 MB + 4092 kB)
+#define VSYSCALL_ADDR 0x087FF000
+
+// model specific registers SYSENTER loads the kernel cs, esp and eip from
+#define MSR_SYSENTER_CS 0x174
+#define MSR_SYSENTER_ESP 0x175
+#define MSR_SYSENTER_EIP 0x176
+
+// cpuid leaf 1 edx bit saying SYSENTER/SYSEXIT are there
+#define CPUID_SEP 0x800
+
+#ifndef ASM
+
+#include "pcb.h"
+
 // system calls
 extern int32_t halt(uint8_t status);
 extern int32_t execute(const uint8_t* command);
@@ -23,6 +49,38 @@ extern int32_t getargs (uint8_t* buf, int32_t nbytes);
 extern int32_t vidmap (uint8_t** screen_start);
 extern int32_t set_handler (int32_t signum, void* handler_address);
 extern int32_t sigreturn (void);
+extern int32_t mmap (int32_t fd, uint8_t** start);
+extern int32_t getdents (int32_t fd, void* buf, int32_t nbytes);
+extern int32_t set_sched_class (int32_t sched_class, int32_t quantum);
+extern int32_t sbrk (int32_t increment);
+extern int32_t getprocs (void* buf, int32_t nbytes);
 extern int32_t system_call_handler();
+extern int32_t sysenter_handler();
+
+// system call stub pages, one of them is mapped at VSYSCALL_ADDR
+extern uint8_t vsyscall_sysenter_page[];
+extern uint8_t vsyscall_int80_page[];
+
+// system call handlers, arguments come from ebx, ecx and edx
+int32_t syscall_halt(uint8_t status);
+int32_t syscall_execute(const uint8_t* command);
+int32_t syscall_read(int32_t fd, void* buf, int32_t nbytes);
+int32_t syscall_write(int32_t fd, const void* buf, int32_t nbytes);
+int32_t syscall_open(const uint8_t* filename);
+int32_t syscall_close(int32_t fd);
+int32_t syscall_getargs(uint8_t* buf, int32_t nbytes);
+int32_t syscall_vidmap(uint8_t** screen_start);
+int32_t syscall_set_handler(int32_t signum, void* handler_address);
+int32_t syscall_sigreturn(void);
+int32_t syscall_mmap(int32_t fd, uint8_t** start);
+int32_t syscall_getdents(int32_t fd, void* buf, int32_t nbytes);
+int32_t syscall_set_sched_class(int32_t sched_class, int32_t quantum);
+int32_t syscall_sbrk(int32_t increment);
+int32_t syscall_getprocs(void* buf, int32_t nbytes);
+
+// set up SYSENTER and map the system call stub page, call after paging_init
+void syscall_init();
+
+#endif /* ASM */
 
 #endif
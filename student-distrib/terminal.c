@@ -2,6 +2,7 @@
 #include "terminals.h"
 
 #include "keyboard.h"
+#include "kmalloc.h"
 #include "lib.h"
 #include "types.h"
 
@@ -14,7 +15,7 @@
  *   OUTPUTS: none
  *   RETURN VALUE: number of bytes written to buf
  *                 -1 for unsuccessful operation
- *   SIDE EFFECTS: none
+ *   SIDE EFFECTS: the process sleeps until enter is pressed on its terminal
  */
 int32_t terminal_read(int32_t fd, void* buf, int32_t nbytes) {
     if (buf == 0) {  // checking nullptr
@@ -40,15 +41,18 @@ int32_t terminal_read(int32_t fd, void* buf, int32_t nbytes) {
         temp[i] = 0;
     }
 
-    // block until enter has been pressed
-    while (!enter_flag[curr_foreground_terminal]) {
+    // sleep until enter has been pressed on this process's terminal
+    cli();
+    while (!enter_flag[curr_terminal]) {
+        sleep_on(&enter_queue[curr_terminal]);
     };
+    sti();
 
-    for (i = 0; i < length[curr_foreground_terminal]; i++) {  // traverse through the current line
+    for (i = 0; i < length[curr_terminal]; i++) {  // traverse through the current line
         if (i < read_bytes) {
             // fill in the temp buffer as much as it can
-            int index = (keyboard_buffer_head[curr_foreground_terminal] + i) % KEYBOARD_BUFFER_SIZE;  // calculates the correct index
-            temp[counter] = keyboard_buffer[curr_foreground_terminal][index];                         // populate temp buffer with keyboard buffer content
+            int index = (keyboard_buffer_head[curr_terminal] + i) % KEYBOARD_BUFFER_SIZE;  // calculates the correct index
+            temp[counter] = keyboard_buffer[curr_terminal][index];                         // populate temp buffer with keyboard buffer content
             counter += 1;                                                   // increment counter
         }
     }
@@ -59,9 +63,9 @@ int32_t terminal_read(int32_t fd, void* buf, int32_t nbytes) {
     }
 
     // we have consumed the current line, moving on to the next and reset the variables
-    keyboard_buffer_head[curr_foreground_terminal] = keyboard_buffer_tail[curr_foreground_terminal];
-    enter_flag[curr_foreground_terminal] = 0;
-    length[curr_foreground_terminal] = 0;
+    keyboard_buffer_head[curr_terminal] = keyboard_buffer_tail[curr_terminal];
+    enter_flag[curr_terminal] = 0;
+    length[curr_terminal] = 0;
 
     // copy buffer_size number of characters into input buf
     memcpy(buf, temp, buffer_size);
@@ -83,22 +87,22 @@ int32_t terminal_write(int32_t fd, const void* buf, int32_t nbytes) {
     if (buf == 0) {  // checking nullptr
         return -1;
     }
-    int i;                  // loop index
-    char inputBuf[nbytes];  // create a buffer of nbytes
-    for (i = 0; i < nbytes; i++) {
-        // initialize the inputBuf buffer to be all 0s
-        inputBuf[i] = 0;
+    int done;               // bytes of buf copied so far
+    int chunk;              // bytes copied this time around
+    char* inputBuf = kmalloc(TERMINAL_WRITE_CHUNK);  // copy of buf, one chunk at a time
+    if (inputBuf == NULL) {
+        return -1;
     }
-    memcpy(inputBuf, buf, nbytes);  // copy from buf to inputBuf
     int counter = 0;                // keeps track of how many character have been printed
-    for (i = 0; i < nbytes; i++) {
-        // loop nbytes times and print to the next position on screen
-        char nextChar = inputBuf[i];
-        if (nextChar != 0){
-            putc(nextChar);
-            counter += 1;
-        }
+    for (done = 0; done < nbytes; done += chunk) {
+        chunk = min(nbytes - done, TERMINAL_WRITE_CHUNK);
+        memcpy(inputBuf, (const char*)buf + done, chunk);  // copy from buf to inputBuf
+        // the whole chunk goes to the back buffer at once
+        counter += putbuf_noflush((uint8_t*)inputBuf, chunk);
     }
+    // one flush and one cursor update for the whole write
+    end_output();
+    kfree(inputBuf);
     return counter;
 }
 
@@ -114,13 +118,13 @@ int32_t terminal_open(const uint8_t* filename) {
     int i;  // loop index
     for (i = 0; i < KEYBOARD_BUFFER_SIZE; i++) {
         // set every index of keyboard buffer to 0
-        keyboard_buffer[curr_foreground_terminal][i] = 0;
+        keyboard_buffer[curr_terminal][i] = 0;
     }
     // reset all keyboard related variables to 0
-    keyboard_buffer_head[curr_foreground_terminal] = 0;
-    keyboard_buffer_tail[curr_foreground_terminal] = 0;
-    length[curr_foreground_terminal] = 0;
-    enter_flag[curr_foreground_terminal] = 0;
+    keyboard_buffer_head[curr_terminal] = 0;
+    keyboard_buffer_tail[curr_terminal] = 0;
+    length[curr_terminal] = 0;
+    enter_flag[curr_terminal] = 0;
     return 0;
 }
 
@@ -136,13 +140,13 @@ int32_t terminal_close(int32_t fd) {
     int i;  // loop index
     for (i = 0; i < KEYBOARD_BUFFER_SIZE; i++) {
         // set every index of keyboard buffer to 0
-        keyboard_buffer[curr_foreground_terminal][i] = 0;
+        keyboard_buffer[curr_terminal][i] = 0;
     }
     // reset all keyboard related variables to 0
-    keyboard_buffer_head[curr_foreground_terminal] = 0;
-    keyboard_buffer_tail[curr_foreground_terminal] = 0;
-    length[curr_foreground_terminal] = 0;
-    enter_flag[curr_foreground_terminal] = 0;
+    keyboard_buffer_head[curr_terminal] = 0;
+    keyboard_buffer_tail[curr_terminal] = 0;
+    length[curr_terminal] = 0;
+    enter_flag[curr_terminal] = 0;
     return 0;
     return 0;
 }
@@ -3,6 +3,8 @@
 
 #include "types.h"
 
+#define TERMINAL_WRITE_CHUNK 1024  // terminal_write copies buf this many bytes at a time
+
 // reads from the keyboard buffer into buf, return number of bytes read
 int32_t terminal_read(int32_t fd, void* buf, int32_t nbytes);
 // writes to the screen from buf, return number of bytes written or -1
@@ -12,13 +12,9 @@ typedef struct terminal {
     pcb_t* curr_pcb;     // current pcb
     int cursor_x;        // x position of cursor
     int cursor_y;        // y position of cursor
-    uint32_t ebp;        // saved ebp
-    uint32_t esp;        // saved esp
-    uint32_t eip;        // saved eip
+    uint32_t esp;        // saved kernel esp, where the scheduler switched away from this terminal
     uint32_t esp0;       // saved esp0
-    uint32_t ss0;        // saved ss0
-    int is_kernel_mode;  // whether terminal is in kernel mode
-    // TODO: input buffer
+    int sleeping;        // whether the active process is waiting on a wait queue
 } terminal_t;
 
 // global array of terminal information
@@ -33,8 +29,8 @@ extern int curr_foreground_terminal;
 // switches to a new terminal specified by target_terminal_id
 void switch_terminal(int target_terminal_id);
 
-// runs the terminal process for the specified terminal
-void run_terminal_process(int target_terminal_id);
+// gets the address of a terminal's back buffer, the page its output is written to
+char* get_page_addr_from_terminal_id(int terminal_id);
 
 // initializes terminal_arr
 void init_terminals();
@@ -0,0 +1,209 @@
+#include "tests.h"
+
+#ifdef BENCH
+
+#include "../syscall.h"
+#include "../lib.h"
+#include "../pcb.h"
+
+#define BENCH_ITERATIONS 1000   // times each cheap operation is timed
+#define BENCH_READ_CHUNK 4096   // bytes asked for by each file read
+#define BENCH_WRITE_LEN 80      // one full line per terminal write
+#define BENCH_NAME_LEN 33       // directory reads give at most 32 characters
+
+static uint8_t read_buf[BENCH_READ_CHUNK];
+
+/*
+ * Kernel side of the benchmarks in syscalls/ece391bench.c. Each operation
+ * is timed through the int $0x80 wrappers and by calling the handler
+ * directly, so the difference is the cost of the trap and dispatch alone.
+ * execute isn't timed here, from the kernel it would drop into user mode
+ * for good, the user benchmark covers it
+ */
+
+/*
+ * report
+ *   DESCRIPTION: prints the cycles per operation of both ways of timing
+ *   INPUTS: name - what was timed
+ *           trap_cycles - total cycles through int $0x80
+ *           direct_cycles - total cycles calling the handler
+ *           ops - number of operations in each total
+ *   OUTPUTS: one line on the screen
+ *   RETURN VALUE: none
+ *   SIDE EFFECTS: none
+ */
+static void report(const char* name, uint32_t trap_cycles, uint32_t direct_cycles, uint32_t ops) {
+    printf("%s: %u cycles/op, %u direct\n", name, trap_cycles / ops, direct_cycles / ops);
+}
+
+/*
+ * bench_empty
+ *   DESCRIPTION: times close on a bad fd, about the least work a system
+ *                call can do
+ *   INPUTS: direct - 1 to call the handler, 0 to go through int $0x80
+ *   OUTPUTS: none
+ *   RETURN VALUE: total cycles of BENCH_ITERATIONS calls
+ *   SIDE EFFECTS: none
+ */
+static uint32_t bench_empty(int direct) {
+    uint32_t start = rdtsc();
+    int i;
+    for (i = 0; i < BENCH_ITERATIONS; i++) {
+        if (direct) {
+            syscall_close(-1);
+        } else {
+            close(-1);
+        }
+    }
+    return rdtsc() - start;
+}
+
+/*
+ * bench_open_close
+ *   DESCRIPTION: times opening and closing a file
+ *   INPUTS: fname - file to open
+ *           direct - 1 to call the handlers, 0 to go through int $0x80
+ *   OUTPUTS: none
+ *   RETURN VALUE: total cycles of BENCH_ITERATIONS open and close pairs
+ *   SIDE EFFECTS: none
+ */
+static uint32_t bench_open_close(const char* fname, int direct) {
+    uint32_t start = rdtsc();
+    int i;
+    for (i = 0; i < BENCH_ITERATIONS; i++) {
+        if (direct) {
+            syscall_close(syscall_open((uint8_t*)fname));
+        } else {
+            close(open((uint8_t*)fname));
+        }
+    }
+    return rdtsc() - start;
+}
+
+/*
+ * bench_read
+ *   DESCRIPTION: times reading a whole file in BENCH_READ_CHUNK pieces,
+ *                the file is reopened each time to start over and only
+ *                the reads are timed
+ *   INPUTS: fname - file to read
+ *           direct - 1 to call the handler, 0 to go through int $0x80
+ *   OUTPUTS: none
+ *   RETURN VALUE: total cycles of BENCH_ITERATIONS whole file reads,
+ *                 0 if the file can't be opened
+ *   SIDE EFFECTS: none
+ */
+static uint32_t bench_read(const char* fname, int direct) {
+    uint32_t total = 0, start;
+    int32_t fd, cnt;
+    int i;
+    for (i = 0; i < BENCH_ITERATIONS; i++) {
+        fd = open((uint8_t*)fname);
+        if (fd == -1) {
+            return 0;
+        }
+        do {
+            start = rdtsc();
+            cnt = direct ? syscall_read(fd, read_buf, BENCH_READ_CHUNK) : read(fd, read_buf, BENCH_READ_CHUNK);
+            total += rdtsc() - start;
+        } while (cnt > 0);
+        close(fd);
+    }
+    return total;
+}
+
+/*
+ * bench_dir_read
+ *   DESCRIPTION: times reading the directory one entry at a time
+ *   INPUTS: direct - 1 to call the handler, 0 to go through int $0x80
+ *   OUTPUTS: reads - number of reads timed, including the one at the end
+ *   RETURN VALUE: total cycles of the reads, 0 if "." can't be opened
+ *   SIDE EFFECTS: none
+ */
+static uint32_t bench_dir_read(int direct, uint32_t* reads) {
+    uint32_t total = 0, start;
+    int32_t fd, cnt;
+    int i;
+    *reads = 0;
+    for (i = 0; i < BENCH_ITERATIONS / 10; i++) {
+        fd = open((uint8_t*)".");
+        if (fd == -1) {
+            return 0;
+        }
+        do {
+            start = rdtsc();
+            cnt = direct ? syscall_read(fd, read_buf, BENCH_NAME_LEN - 1) : read(fd, read_buf, BENCH_NAME_LEN - 1);
+            total += rdtsc() - start;
+            (*reads)++;
+        } while (cnt > 0);
+        close(fd);
+    }
+    return total;
+}
+
+/*
+ * bench_terminal_write
+ *   DESCRIPTION: times a burst of full line writes to the terminal
+ *   INPUTS: direct - 1 to call the handler, 0 to go through int $0x80
+ *   OUTPUTS: BENCH_ITERATIONS / 10 lines on the screen
+ *   RETURN VALUE: total cycles of the writes
+ *   SIDE EFFECTS: scrolls the screen
+ */
+static uint32_t bench_terminal_write(int direct) {
+    uint8_t line[BENCH_WRITE_LEN];
+    uint32_t start;
+    int i;
+    for (i = 0; i < BENCH_WRITE_LEN - 1; i++) {
+        line[i] = 'a' + i % 26;
+    }
+    line[BENCH_WRITE_LEN - 1] = '\n';
+    start = rdtsc();
+    for (i = 0; i < BENCH_ITERATIONS / 10; i++) {
+        if (direct) {
+            syscall_write(1, line, BENCH_WRITE_LEN);
+        } else {
+            write(1, line, BENCH_WRITE_LEN);
+        }
+    }
+    return rdtsc() - start;
+}
+
+/*
+ * launch_bench
+ *   DESCRIPTION: runs every benchmark both ways and prints the cycles
+ *                per operation
+ *   INPUTS: none
+ *   OUTPUTS: results on the screen
+ *   RETURN VALUE: none
+ *   SIDE EFFECTS: takes a pid for the file descriptors the system calls use,
+ *                 and gives it back before returning
+ */
+void launch_bench() {
+    uint32_t trap_cycles, direct_cycles, reads;
+    int pid = create_pcb(-1, 0, 0);
+    if (pid == -1) {
+        printf("bench: no pid\n");
+        return;
+    }
+    point_curr_pcb(pid);
+
+    // the writes go first so they don't scroll the results away
+    trap_cycles = bench_terminal_write(0);
+    direct_cycles = bench_terminal_write(1);
+    clear();
+    report("terminal write 80 B", trap_cycles, direct_cycles, BENCH_ITERATIONS / 10);
+
+    report("empty syscall", bench_empty(0), bench_empty(1), BENCH_ITERATIONS);
+    report("open+close", bench_open_close("frame0.txt", 0), bench_open_close("frame0.txt", 1), BENCH_ITERATIONS);
+    report("read 187 B file", bench_read("frame0.txt", 0), bench_read("frame0.txt", 1), BENCH_ITERATIONS);
+    report("read 5 kB file", bench_read("verylargetextwithverylongname.txt", 0), bench_read("verylargetextwithverylongname.txt", 1), BENCH_ITERATIONS);
+    report("read 8 kB file", bench_read("syserr", 0), bench_read("syserr", 1), BENCH_ITERATIONS);
+    trap_cycles = bench_dir_read(0, &reads);
+    direct_cycles = bench_dir_read(1, &reads);
+    if (reads != 0) {
+        report("dir read", trap_cycles, direct_cycles, reads);
+    }
+    clear_pid(pid);
+    curr_pcb = NULL;  // the shell starts with no process running
+}
+
+#endif /* BENCH */
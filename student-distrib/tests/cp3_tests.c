@@ -83,10 +83,10 @@ int improved_system_call_test() {
  */
 int find_avail_pid_test() {
     int pid;
-    pcb_arr[0]->available = 0; // set unavail
-    pcb_arr[1]->available = 1; // set avail
+    pcb_arr_init(); // init pid_arr so all are avail
+    create_pcb(-1, 0, 0); // take pid 0
     pid = find_avail_pid(); // find avail pid
-    if((pid == 1) && (pcb_arr[pid]->process_id == 1))
+    if(pid == 1)
         return PASS; // pid marked unavail
     else
         return FAIL; // could not find avail pid
@@ -94,7 +94,7 @@ int find_avail_pid_test() {
 
 /*
  * neither_pid_avail_test
- *   DESCRIPTION: return -1 if neither pids are available
+ *   DESCRIPTION: return -1 if no pids are available
  *   INPUTS: NONE
  *   OUTPUTS: NONE
  *   SIDE EFFECTS: cannot assign pid
@@ -103,8 +103,9 @@ int find_avail_pid_test() {
 int neither_pid_avail_test() {
     int pid;
     int i;
-    for (i = 0; i < 6; i++) {
-        pcb_arr[i]->available = 0; // set unavail
+    pcb_arr_init(); // init pid_arr so all are avail
+    for (i = 0; i < MAX_PROC; i++) {
+        create_pcb(-1, 0, 0); // set unavail
     }
     pid = find_avail_pid();
     if(pid == -1) // cant find pid, return PASS
@@ -122,7 +123,8 @@ int neither_pid_avail_test() {
  *   COVERAGE: pcb.c -- clear_pid
  */
 int clear_pid_test() {
-    pcb_arr[0]->available = 0; // set unavail
+    pcb_arr_init(); // init pid_arr so all are avail
+    create_pcb(-1, 0, 0); // set pid 0 unavail
     int val = clear_pid(0); // clear pid 0
     if(val == 0) // return 0 if clear success
         return PASS;
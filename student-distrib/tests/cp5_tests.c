@@ -9,6 +9,11 @@
 #include "../rtc.h"
 #include "../terminal.h"
 #include "../filesystem.h" 
+#include "../paging.h"
+#include "../scheduler.h"
+#include "../kmalloc.h"
+#include "../scrollback.h"
+#include "../terminals.h"
 
 #define PASS 1
 #define FAIL 0
@@ -44,10 +49,452 @@ int execute_garbage_input_test() {
     return result;
 }
 
+/*
+ * dentry_index_test
+ *   DESCRIPTION: looks up every file in the boot block by
+ *      name and checks the index returns the dentry at the
+ *      first position holding that name
+ *   INPUTS: NONE
+ *   OUTPUTS: NONE
+ *   SIDE EFFECTS: NONE
+ *   COVERAGE: filesystem.c -- read_dentry_by_name, lookup_dentry
+ */
+int dentry_index_test() {
+    TEST_HEADER;
+    dentry_t by_index, by_name;
+    int i;
+    for (i = 0; i < filesystem.boot_block->dir_count; i++) {
+        if (read_dentry_by_index(i, &by_index) == -1 || read_dentry_by_name((uint8_t*)by_index.filename, &by_name) == -1) {
+            return FAIL;
+        }
+        if (by_name.inode_num != by_index.inode_num || by_name.filetype != by_index.filetype) {
+            return FAIL;
+        }
+    }
+    // a name that isn't in the boot block must miss
+    if (read_dentry_by_name((uint8_t*)"abcdefg", &by_name) != -1) {
+        return FAIL;
+    }
+    return PASS;
+}
+
+/* frame_refcount_test
+ *   DESCRIPTION: takes a frame from the pool, shares it, and
+ *      checks it only goes back to the pool after the last
+ *      reference is dropped
+ *   INPUTS: NONE
+ *   OUTPUTS: NONE
+ *   SIDE EFFECTS: NONE
+ *   COVERAGE: paging.c -- alloc_frame, get_frame, put_frame
+ */
+int frame_refcount_test() {
+    TEST_HEADER;
+    uint32_t frame = alloc_frame();
+    uint32_t other;
+    if (frame == 0) {
+        return FAIL;
+    }
+    get_frame(frame);
+    put_frame(frame);
+    // still referenced once, so the pool must hand out a different frame
+    other = alloc_frame();
+    if (other == 0 || other == frame) {
+        return FAIL;
+    }
+    put_frame(other);
+    put_frame(frame);
+    // frames are reused last freed first
+    other = alloc_frame();
+    put_frame(other);
+    if (other != frame) {
+        return FAIL;
+    }
+    return PASS;
+}
+
+/* process_memory_test
+ *   DESCRIPTION: empties the frame pool and checks that no process
+ *      can be started, then puts the frames back
+ *   INPUTS: NONE
+ *   OUTPUTS: NONE
+ *   SIDE EFFECTS: NONE
+ *   COVERAGE: paging.c -- process_memory_available
+ */
+int process_memory_test() {
+    TEST_HEADER;
+    uint32_t frame, taken = 0;
+    int result = PASS;
+    if (process_memory_available(-1) || !process_memory_available(find_avail_pid())) {
+        return FAIL;
+    }
+    // each frame taken holds the address of the one taken before it
+    while ((frame = alloc_frame()) != 0) {
+        *(uint32_t*)frame = taken;
+        taken = frame;
+    }
+    if (process_memory_available(find_avail_pid())) {
+        result = FAIL;
+    }
+    while (taken != 0) {
+        frame = *(uint32_t*)taken;
+        put_frame(taken);
+        taken = frame;
+    }
+    return result;
+}
+
+/* write_data_append_test
+ *   DESCRIPTION: creates a file, appends to it across a block
+ *      boundary and reads the whole thing back
+ *   INPUTS: NONE
+ *   OUTPUTS: NONE
+ *   SIDE EFFECTS: adds "appendtest" to the filesystem
+ *   COVERAGE: filesystem.c -- create_file, write_data, read_data
+ */
+int write_data_append_test() {
+    TEST_HEADER;
+    static uint8_t buf[BLOCK_SIZE + BLOCK_SIZE / 2];
+    static uint8_t back[BLOCK_SIZE + BLOCK_SIZE / 2];
+    dentry_t dir_entry;
+    int i;
+    for (i = 0; i < sizeof(buf); i++) {
+        buf[i] = (uint8_t)i;
+    }
+    if (create_file((uint8_t*)"appendtest", 10) == -1 || read_dentry_by_name((uint8_t*)"appendtest", &dir_entry) == -1) {
+        return FAIL;
+    }
+    // first write stops short of the block boundary, second one crosses it
+    if (write_data(dir_entry.inode_num, 0, buf, BLOCK_SIZE - 100) != BLOCK_SIZE - 100) {
+        return FAIL;
+    }
+    if (write_data(dir_entry.inode_num, BLOCK_SIZE - 100, buf + BLOCK_SIZE - 100, sizeof(buf) - (BLOCK_SIZE - 100)) != sizeof(buf) - (BLOCK_SIZE - 100)) {
+        return FAIL;
+    }
+    if (read_data(dir_entry.inode_num, 0, back, sizeof(back)) != sizeof(back)) {
+        return FAIL;
+    }
+    for (i = 0; i < sizeof(buf); i++) {
+        if (back[i] != buf[i]) {
+            return FAIL;
+        }
+    }
+    // writes past the end of the file would leave a hole
+    if (write_data(dir_entry.inode_num, sizeof(buf) + 1, buf, 1) != -1) {
+        return FAIL;
+    }
+    return PASS;
+}
+
+/* write_running_exec_test
+ *   DESCRIPTION: makes sure a file can't be written while a running
+ *      process was loaded from it, and can be once the process is gone
+ *   INPUTS: NONE
+ *   OUTPUTS: NONE
+ *   SIDE EFFECTS: adds "runningtest" to the filesystem, takes and
+ *      gives back a pid
+ *   COVERAGE: filesystem.c -- write_data, pcb.c -- exec_inode_in_use
+ */
+int write_running_exec_test() {
+    TEST_HEADER;
+    dentry_t dir_entry;
+    uint8_t byte = 0x7F;
+    int pid;
+    if (create_file((uint8_t*)"runningtest", 11) == -1 || read_dentry_by_name((uint8_t*)"runningtest", &dir_entry) == -1) {
+        return FAIL;
+    }
+    pid = create_pcb(-1, 0, 0);
+    if (pid == -1) {
+        return FAIL;
+    }
+    pcb_arr[pid]->exec_inode = dir_entry.inode_num;
+    if (write_data(dir_entry.inode_num, 0, &byte, 1) != -1) {
+        clear_pid(pid);
+        return FAIL;
+    }
+    clear_pid(pid);
+    if (write_data(dir_entry.inode_num, 0, &byte, 1) != 1) {
+        return FAIL;
+    }
+    return PASS;
+}
+
+/* sched_class_bad_input_test
+ *   DESCRIPTION: makes sure bad classes and time slices are rejected
+ *      before anything is changed
+ *   INPUTS: NONE
+ *   OUTPUTS: NONE
+ *   SIDE EFFECTS: NONE
+ *   COVERAGE: scheduler.c -- change_sched_class
+ */
+int sched_class_bad_input_test() {
+    TEST_HEADER;
+    if (change_sched_class(-1, 0) != -1 || change_sched_class(SCHED_NUM_CLASSES, 0) != -1) {
+        return FAIL;
+    }
+    if (change_sched_class(SCHED_CLASS_BATCH, -1) != -1 || change_sched_class(SCHED_CLASS_BATCH, SCHED_MAX_QUANTUM + 1) != -1) {
+        return FAIL;
+    }
+    // the auto class has no time slice of its own
+    if (change_sched_class(SCHED_CLASS_AUTO, 1) != -1) {
+        return FAIL;
+    }
+    return PASS;
+}
+
+/* kmalloc_test
+ *   DESCRIPTION: allocates from two size classes, checks the objects
+ *      don't overlap and that freed objects get handed out again
+ *   INPUTS: NONE
+ *   OUTPUTS: NONE
+ *   SIDE EFFECTS: NONE
+ *   COVERAGE: kmalloc.c -- kmalloc, kfree
+ */
+int kmalloc_test() {
+    TEST_HEADER;
+    uint8_t* small = kmalloc(24);
+    uint8_t* other = kmalloc(24);
+    uint8_t* big = kmalloc(KMALLOC_MAX_SIZE);
+    if (small == NULL || other == NULL || big == NULL || small == other) {
+        return FAIL;
+    }
+    // 24 bytes comes out of the 32 byte class, on separate pages from the big one
+    if ((other > small ? other - small : small - other) < 32 || ((uint32_t)small & ZERO_ATTRIBUTE) == ((uint32_t)big & ZERO_ATTRIBUTE)) {
+        return FAIL;
+    }
+    memset(small, 0xAA, 24);
+    memset(other, 0x55, 24);
+    if (small[23] != 0xAA) {
+        return FAIL;
+    }
+    kfree(other);
+    // the object freed last is the first one handed out again
+    if (kmalloc(20) != other) {
+        return FAIL;
+    }
+    kfree(other);
+    kfree(small);
+    kfree(big);
+    if (kmalloc(0) != NULL || kmalloc(KMALLOC_MAX_SIZE + 1) != NULL) {
+        return FAIL;
+    }
+    return PASS;
+}
+
+/* Vsyscall Page Test
+ *
+ * Checks the system call stub page is mapped read only for user
+ * programs, and that int $0x80 from the kernel still reaches the
+ * handlers with the arguments in registers
+ * Inputs: None
+ * Outputs: PASS/FAIL
+ * Side Effects: None
+ * Coverage: syscall_init, system_call_handler
+ * Files: syscall.c/h, syscall_asm.S
+ */
+int vsyscall_page_test() {
+    TEST_HEADER;
+    uint32_t pte = vidmap_page_table[(VSYSCALL_ADDR >> VIDMAP_PTE_IDX_POS) & (ENTRIES - 1)];
+    uint32_t page = pte & ZERO_ATTRIBUTE;
+    if ((pte & ~ZERO_ATTRIBUTE) != VSYSCALL_PTE) {
+        return FAIL;
+    }
+    if (page != (uint32_t)vsyscall_sysenter_page && page != (uint32_t)vsyscall_int80_page) {
+        return FAIL;
+    }
+    // a bad fd and a bad class both come back as -1 through the int $0x80 path
+    if (close(FD_SIZE) != -1 || set_sched_class(SCHED_NUM_CLASSES, 0) != -1) {
+        return FAIL;
+    }
+    return PASS;
+}
+
+/* Proc Info Test
+ *
+ * Checks a new process starts with zeroed counters and shows up in
+ * get_proc_infos with them, and that a full buffer stops the copy
+ * Inputs: None
+ * Outputs: PASS/FAIL
+ * Side Effects: takes and gives back a pid
+ * Coverage: get_proc_infos, create_pcb
+ * Files: pcb.c/h
+ */
+int proc_info_test() {
+    TEST_HEADER;
+    static proc_info_t infos[MAX_PROC];  // too big for the stack
+    int32_t i, n, found = 0;
+    int pid = create_pcb(-1, 0, 0);
+    if (pid == -1) {
+        return FAIL;
+    }
+    if (pcb_arr[pid]->stats.syscalls != 0 || pcb_arr[pid]->stats.ticks != 0 || pcb_arr[pid]->stats.page_faults != 0) {
+        clear_pid(pid);
+        return FAIL;
+    }
+    pcb_arr[pid]->stats.bytes_read = 42;
+    n = get_proc_infos(infos, MAX_PROC);
+    for (i = 0; i < n; i++) {
+        if (infos[i].pid == pid && infos[i].parent_id == -1 && infos[i].stats.bytes_read == 42) {
+            found = 1;
+        }
+    }
+    if (!found || get_proc_infos(infos, 0) != 0) {
+        clear_pid(pid);
+        return FAIL;
+    }
+    clear_pid(pid);
+    // a free pid isn't a running process
+    n = get_proc_infos(infos, MAX_PROC);
+    for (i = 0; i < n; i++) {
+        if (infos[i].pid == pid) {
+            return FAIL;
+        }
+    }
+    return PASS;
+}
+
+/* Back Buffer Test
+ *
+ * Checks output to a background terminal only lands in its back buffer,
+ * and that after a redraw the screen is the foreground back buffer
+ * Inputs: None
+ * Outputs: PASS/FAIL
+ * Side Effects: prints a line to the foreground terminal and a character
+ *               to the next terminal
+ * Coverage: putbuf, flush_screen, redraw_screen
+ * Files: lib.c/h, terminals.c/h
+ */
+int back_buffer_test() {
+    TEST_HEADER;
+    int fg = curr_foreground_terminal;
+    int bg = (fg + 1) % NUM_TERMINALS;
+    int old_terminal = get_screen_terminal();
+    int result = PASS;
+    int i;
+    uint16_t* cell;
+    uint32_t flags;
+    cli_and_save(flags);
+    set_screen_terminal(bg);
+    cell = (uint16_t*)get_page_addr_from_terminal_id(bg) + screen_y * NUM_COLS + screen_x;
+    putbuf((uint8_t*)"~", 1);
+    if (*cell != ((ATTRIB << 8) | '~')) {
+        result = FAIL;
+    }
+    set_screen_terminal(fg);
+    putbuf((uint8_t*)"back buffer\n", 12);
+    // nothing of bg's is on screen, all of fg's is
+    redraw_screen();
+    cell = (uint16_t*)get_page_addr_from_terminal_id(fg);
+    for (i = 0; i < NUM_ROWS * NUM_COLS; i++) {
+        if (((uint16_t*)VIDEO)[i] != cell[i]) {
+            result = FAIL;
+        }
+    }
+    set_screen_terminal(old_terminal);
+    restore_flags(flags);
+    return result;
+}
+
+/* Vidmap Remap Test
+ *
+ * Checks a process's vidmap page follows its terminal, video memory while
+ * it is on screen and the terminal's back buffer while it isn't, and that
+ * pids which never called vidmap are left alone
+ * Inputs: None
+ * Outputs: PASS/FAIL
+ * Side Effects: takes and gives back a pid
+ * Coverage: map_vidmap_page, remap_vidmap_pages
+ * Files: paging.c/h
+ */
+int vidmap_remap_test() {
+    TEST_HEADER;
+    int result = PASS;
+    int fg = curr_foreground_terminal;
+    int bg = (fg + 1) % NUM_TERMINALS;
+    uint32_t old_entry;
+    int pid = create_pcb(-1, 0, 0);
+    if (pid == -1) {
+        return FAIL;
+    }
+    old_entry = vidmap_page_table[pid];
+    vidmap_page_table[pid] &= ~PAGE_PRESENT;
+    remap_vidmap_pages();
+    if (vidmap_page_table[pid] & PAGE_PRESENT) {
+        result = FAIL;
+    }
+    pcb_arr[pid]->terminal = bg;
+    map_vidmap_page(pid);
+    if (vidmap_page_table[pid] != ((uint32_t)get_page_addr_from_terminal_id(bg) | VIDMEM_PTE)) {
+        result = FAIL;
+    }
+    pcb_arr[pid]->terminal = fg;
+    remap_vidmap_pages();
+    if (vidmap_page_table[pid] != ((VIDMEM_PAGE_IDX * KB_OFFSET) | VIDMEM_PTE)) {
+        result = FAIL;
+    }
+    vidmap_page_table[pid] = old_entry;
+    flush_tlb();
+    clear_pid(pid);
+    return result;
+}
+
+/* Scrollback Test
+ *
+ * Checks a line pushed into the foreground terminal's history is drawn
+ * above its screen when the view moves up one line, and that the view
+ * goes back to the live screen
+ * Inputs: None
+ * Outputs: PASS/FAIL
+ * Side Effects: adds a line to the foreground terminal's history
+ * Coverage: scrollback_push, scrollback_scroll, scrollback_end
+ * Files: scrollback.c/h
+ */
+int scrollback_test() {
+    TEST_HEADER;
+    int result = PASS;
+    int x;
+    uint16_t row[NUM_COLS];
+    uint16_t* screen = (uint16_t*)VIDEO;
+    uint16_t* back_buf = (uint16_t*)get_page_addr_from_terminal_id(curr_foreground_terminal);
+    uint32_t flags;
+    for (x = 0; x < NUM_COLS; x++) {
+        row[x] = (ATTRIB << 8) | ('a' + x % 26);
+    }
+    cli_and_save(flags);
+    scrollback_push(curr_foreground_terminal, row);
+    scrollback_scroll(1);
+    if (!scrollback_viewing()) {
+        result = FAIL;
+    }
+    for (x = 0; x < NUM_COLS; x++) {
+        // the pushed line on top, then the screen from its first row
+        if (screen[x] != row[x] || screen[NUM_COLS + x] != back_buf[x]) {
+            result = FAIL;
+        }
+    }
+    scrollback_end();
+    if (scrollback_viewing() || screen[0] != back_buf[0]) {
+        result = FAIL;
+    }
+    restore_flags(flags);
+    return result;
+}
+
 /* Test suite entry point */
 void launch_tests_cp5() {
     clear();
     // TEST_OUTPUT("execute garbage input test", execute_garbage_input_test());
+    // TEST_OUTPUT("dentry index test", dentry_index_test());
+    // TEST_OUTPUT("frame refcount test", frame_refcount_test());
+    // TEST_OUTPUT("process memory test", process_memory_test());
+    // TEST_OUTPUT("write data append test", write_data_append_test());
+    // TEST_OUTPUT("write running exec test", write_running_exec_test());
+    // TEST_OUTPUT("sched class bad input test", sched_class_bad_input_test());
+    // TEST_OUTPUT("kmalloc test", kmalloc_test());
+    // TEST_OUTPUT("vsyscall page test", vsyscall_page_test());
+    // TEST_OUTPUT("proc info test", proc_info_test());
+    // TEST_OUTPUT("back buffer test", back_buffer_test());
+    // TEST_OUTPUT("vidmap remap test", vidmap_remap_test());
+    // TEST_OUTPUT("scrollback test", scrollback_test());
 }
 
 #endif
@@ -9,6 +9,7 @@
 // #define CP3
 // #define CP4
 #define CP5
+// #define BENCH  // cycle counts of the system calls, see bench.c
 
 
 // test launcher
@@ -17,5 +18,6 @@ void launch_tests_cp2();
 void launch_tests_cp3();
 void launch_tests_cp4();
 void launch_tests_cp5();
+void launch_bench();
 
 #endif /* TESTS_H */
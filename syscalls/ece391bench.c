@@ -0,0 +1,172 @@
+#include <stdint.h>
+
+#include "ece391support.h"
+#include "ece391syscall.h"
+
+#define ITERATIONS 1000		/* times each cheap operation is timed */
+#define EXEC_ITERATIONS 50	/* execute is much slower, fewer runs */
+#define READ_CHUNK 4096		/* bytes asked for by each file read */
+#define WRITE_LEN 80		/* one full line per terminal write */
+#define SBUFSIZE 33
+
+static uint8_t read_buf[READ_CHUNK];
+
+/*
+ * Low 32 bits of the time stamp counter.  A difference of two reads is
+ * right as long as they are less than 2^32 cycles apart, and there is
+ * no 64-bit division without libgcc anyway.
+ */
+static inline uint32_t
+rdtsc ()
+{
+    uint32_t lo, hi;
+
+    asm volatile ("rdtsc" : "=a" (lo), "=d" (hi));
+    return lo;
+}
+
+static void
+report (const char* name, uint32_t cycles, uint32_t ops)
+{
+    uint8_t buf[SBUFSIZE];
+
+    ece391_fdputs (1, (uint8_t*)name);
+    ece391_fdputs (1, (uint8_t*)": ");
+    ece391_itoa (cycles / ops, buf, 10);
+    ece391_fdputs (1, buf);
+    ece391_fdputs (1, (uint8_t*)" cycles/op\n");
+}
+
+/* close on a bad fd, about the least work a system call can do */
+static uint32_t
+bench_empty ()
+{
+    uint32_t start, i;
+
+    start = rdtsc ();
+    for (i = 0; i < ITERATIONS; i++)
+        ece391_close (-1);
+    return rdtsc () - start;
+}
+
+static uint32_t
+bench_open_close (const char* fname)
+{
+    uint32_t start, i;
+
+    start = rdtsc ();
+    for (i = 0; i < ITERATIONS; i++)
+        ece391_close (ece391_open ((uint8_t*)fname));
+    return rdtsc () - start;
+}
+
+/*
+ * Reads the whole file, only the reads are timed.  The file is reopened
+ * to start over.  Returns 0 if the file isn't there.
+ */
+static uint32_t
+bench_read (const char* fname)
+{
+    uint32_t total, start, i;
+    int32_t fd, cnt;
+
+    total = 0;
+    for (i = 0; i < ITERATIONS; i++) {
+        if (-1 == (fd = ece391_open ((uint8_t*)fname)))
+	    return 0;
+	do {
+	    start = rdtsc ();
+	    cnt = ece391_read (fd, read_buf, READ_CHUNK);
+	    total += rdtsc () - start;
+	} while (cnt > 0);
+	ece391_close (fd);
+    }
+    return total;
+}
+
+/* one read per directory entry, including the one at the end */
+static uint32_t
+bench_dir_read (uint32_t* reads)
+{
+    uint32_t total, start, i;
+    int32_t fd, cnt;
+
+    total = 0;
+    *reads = 0;
+    for (i = 0; i < ITERATIONS / 10; i++) {
+        if (-1 == (fd = ece391_open ((uint8_t*)".")))
+	    return 0;
+	do {
+	    start = rdtsc ();
+	    cnt = ece391_read (fd, read_buf, SBUFSIZE - 1);
+	    total += rdtsc () - start;
+	    (*reads)++;
+	} while (cnt > 0);
+	ece391_close (fd);
+    }
+    return total;
+}
+
+/* runs this program again with "nop", which returns right away */
+static uint32_t
+bench_execute ()
+{
+    uint32_t start, i;
+
+    start = rdtsc ();
+    for (i = 0; i < EXEC_ITERATIONS; i++)
+        ece391_execute ((uint8_t*)"bench nop");
+    return rdtsc () - start;
+}
+
+static uint32_t
+bench_terminal_write ()
+{
+    uint8_t line[WRITE_LEN];
+    uint32_t start, i;
+
+    for (i = 0; i < WRITE_LEN - 1; i++)
+        line[i] = 'a' + i % 26;
+    line[WRITE_LEN - 1] = '\n';
+    start = rdtsc ();
+    for (i = 0; i < ITERATIONS / 10; i++)
+        ece391_write (1, line, WRITE_LEN);
+    return rdtsc () - start;
+}
+
+int main ()
+{
+    uint8_t arg[SBUFSIZE];
+    uint32_t empty, open_close, small, medium, large, dir, exec, term;
+    uint32_t dir_reads;
+
+    /* the child started by bench_execute */
+    if (0 == ece391_getargs (arg, SBUFSIZE - 1) &&
+        0 == ece391_strcmp (arg, (uint8_t*)"nop"))
+        return 0;
+
+    /* run everything before printing, so the results stay on screen */
+    empty = bench_empty ();
+    open_close = bench_open_close ("frame0.txt");
+    small = bench_read ("frame0.txt");
+    medium = bench_read ("verylargetextwithverylongname.txt");
+    large = bench_read ("syserr");
+    dir = bench_dir_read (&dir_reads);
+    exec = bench_execute ();
+    term = bench_terminal_write ();
+
+    report ("empty syscall", empty, ITERATIONS);
+    report ("open+close", open_close, ITERATIONS);
+    if (0 != small)
+	report ("read 187 B file", small, ITERATIONS);
+    if (0 != medium)
+	report ("read 5 kB file", medium, ITERATIONS);
+    if (0 != large)
+	report ("read 8 kB file", large, ITERATIONS);
+    if (0 != dir_reads)
+	report ("dir read", dir, dir_reads);
+    report ("execute+halt", exec, EXEC_ITERATIONS);
+    report ("terminal write 80 B", term, ITERATIONS / 10);
+
+    return 0;
+}
@@ -5,8 +5,9 @@
 
 int main ()
 {
-    int32_t fd, cnt;
+    int32_t fd, cnt, len, pos;
     uint8_t buf[1024];
+    uint8_t* file;
 
     if (0 != ece391_getargs (buf, 1024)) {
         ece391_fdputs (1, (uint8_t*)"could not read arguments\n");
@@ -18,6 +19,16 @@ int main ()
 	return 2;
     }
 
+    /* write straight out of the filesystem image if it can be mapped */
+    if (-1 != (len = ece391_mmap (fd, &file))) {
+	for (pos = 0; pos < len; pos += cnt) {
+	    cnt = (len - pos < 1024) ? len - pos : 1024;
+	    if (-1 == ece391_write (1, file + pos, cnt))
+		return 3;
+	}
+	return 0;
+    }
+
     while (0 != (cnt = ece391_read (fd, buf, 1024))) {
         if (-1 == cnt) {
 	    ece391_fdputs (1, (uint8_t*)"file read failed\n");
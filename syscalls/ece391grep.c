@@ -6,35 +6,74 @@
 #define BUFSIZE 1024
 #define SBUFSIZE 33
 
+/* Makes the line buffer twice as big, keeping the first last bytes.
+   Returns the new buffer, or 0 (leaving the old one) if out of memory. */
+static uint8_t*
+grow_buffer (uint8_t* data, int32_t* size, int32_t last)
+{
+    uint8_t* bigger;
+    int32_t i;
+
+    if (0 == (bigger = ece391_malloc (2 * *size + 1)))
+        return 0;
+    for (i = 0; i < last; i++)
+        bigger[i] = data[i];
+    ece391_free (data);
+    *size *= 2;
+    return bigger;
+}
+
 int32_t
 do_one_file (const char* s, const char* fname) 
 {
-    int32_t fd, cnt, last, line_start, line_end, check, s_len;
-    uint8_t data[BUFSIZE+1];
+    int32_t fd, cnt, last, line_start, line_end, check, s_len, size;
+    uint8_t* data;
+    uint8_t* bigger;
 
     s_len = ece391_strlen ((uint8_t*)s);
     if (-1 == (fd = ece391_open ((uint8_t*)fname))) {
         ece391_fdputs (1, (uint8_t*)"file open failed\n");
         return -1;
     }
+    /* the buffer grows to hold the longest line in the file */
+    size = BUFSIZE;
+    if (0 == (data = ece391_malloc (size + 1))) {
+        ece391_fdputs (1, (uint8_t*)"out of memory\n");
+        ece391_close (fd);
+        return -1;
+    }
     last = 0;
     while (1) {
-        cnt = ece391_read (fd, data + last, BUFSIZE - last);
+        if (last == size) {
+	    if (0 == (bigger = grow_buffer (data, &size, last))) {
+		ece391_fdputs (1, (uint8_t*)"out of memory\n");
+		ece391_free (data);
+		ece391_close (fd);
+		return -1;
+	    }
+	    data = bigger;
+	}
+        cnt = ece391_read (fd, data + last, size - last);
 	if (-1 == cnt) {
             ece391_fdputs (1, (uint8_t*)"file read failed\n");
+            ece391_free (data);
             return -1;
 	}
 	last += cnt;
+	data[last] = '\0';
 	line_start = 0;
 	while (1) {
 	    line_end = line_start;
 	    while (line_end < last && '\n' != data[line_end])
 		line_end++;
-	    if ('\n' != data[line_end] && 0 != cnt && line_start != 0) {
-		/* copy from line_start to last down to 0 and fix last */
-		data[line_end] = '\0';
-		ece391_strcpy (data, data + line_start);
-		last -= line_start;
+	    if ('\n' != data[line_end] && 0 != cnt) {
+		/* copy from line_start to last down to 0 and fix last,
+		   then read the rest of the line */
+		if (0 != line_start) {
+		    data[line_end] = '\0';
+		    ece391_strcpy (data, data + line_start);
+		    last -= line_start;
+		}
 		break;
 	    }
 	    /* search the line */
@@ -58,6 +97,7 @@ do_one_file (const char* s, const char* fname)
 	if (0 == cnt)
 	    break;
     }
+    ece391_free (data);
     if (-1 == ece391_close (fd)) {
         ece391_fdputs (1, (uint8_t*)"file close failed\n");
         return -1;
@@ -4,25 +4,37 @@
 #include "ece391syscall.h"
 
 #define SBUFSIZE 33
+#define NAMELEN 32
+#define NUM_RECORDS 16
 
 int main ()
 {
-    int32_t fd, cnt;
-    uint8_t buf[SBUFSIZE];
+    int32_t fd, cnt, i, j;
+    struct ece391_dirent records[NUM_RECORDS];
+    uint8_t buf[SBUFSIZE + 12];
 
     if (-1 == (fd = ece391_open ((uint8_t*)"."))) {
         ece391_fdputs (1, (uint8_t*)"directory open failed\n");
         return 2;
     }
 
-    while (0 != (cnt = ece391_read (fd, buf, SBUFSIZE-1))) {
+    while (0 != (cnt = ece391_getdents (fd, records, sizeof (records)))) {
         if (-1 == cnt) {
 	        ece391_fdputs (1, (uint8_t*)"directory entry read failed\n");
 	        return 3;
 	    }
-	    buf[cnt] = '\n';
-	    if (-1 == ece391_write (1, buf, cnt + 1))
-	        return 3;
+	    for (i = 0; i < cnt / (int32_t)sizeof (struct ece391_dirent); i++) {
+		/* name padded out to a column, then the size */
+		for (j = 0; j < NAMELEN && '\0' != records[i].name[j]; j++)
+		    buf[j] = records[i].name[j];
+		for (; j < SBUFSIZE; j++)
+		    buf[j] = ' ';
+		ece391_itoa (records[i].size, buf + SBUFSIZE, 10);
+		j = ece391_strlen (buf);
+		buf[j] = '\n';
+		if (-1 == ece391_write (1, buf, j + 1))
+		    return 3;
+	    }
     }
 
     return 0;
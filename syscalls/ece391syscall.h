@@ -21,6 +21,54 @@ extern int32_t ece391_getargs (uint8_t* buf, int32_t nbytes);
 extern int32_t ece391_vidmap (uint8_t** screen_start);
 extern int32_t ece391_set_handler (int32_t signum, void* handler);
 extern int32_t ece391_sigreturn (void);
+/* Maps an open regular file read-only; returns its length and sets
+ * *start to the first byte. */
+extern int32_t ece391_mmap (int32_t fd, uint8_t** start);
+/* Reads as many directory records as fit in buf from an open
+ * directory; returns the number of bytes filled, 0 at the end. */
+extern int32_t ece391_getdents (int32_t fd, void* buf, int32_t nbytes);
+/* Moves the calling process (and the children it starts afterwards)
+ * to a scheduling class.  A nonzero quantum also sets the time slice
+ * of that class in timer ticks. */
+extern int32_t ece391_set_sched_class (int32_t sched_class, int32_t quantum);
+/* Grows (or, with a negative increment, shrinks) the heap; returns
+ * the old end of the heap, or (void*)-1.  New memory reads as zero. */
+extern void* ece391_sbrk (int32_t increment);
+/* Fills buf with a struct ece391_procinfo for each running process;
+ * returns the number of bytes filled. */
+extern int32_t ece391_getprocs (void* buf, int32_t nbytes);
+
+/* One record from ece391_getdents.  The name is not NUL-terminated
+ * when it is 32 characters long; size is 0 for anything but a
+ * regular file. */
+struct ece391_dirent {
+	uint8_t name[32];
+	int32_t type;
+	int32_t inode;
+	int32_t size;
+};
+
+/* One record from ece391_getprocs.  The counters run from the start
+ * of the process; ticks are 10 ms timer ticks spent running.  The
+ * name is not NUL-terminated when it is 32 characters long. */
+struct ece391_procinfo {
+	int32_t pid;
+	int32_t parent;
+	int32_t terminal;
+	int32_t sched_class;
+	uint8_t name[32];
+	uint32_t syscalls;
+	uint32_t ticks;
+	uint32_t bytes_read;
+	uint32_t bytes_written;
+	uint32_t page_faults;
+};
+
+enum sched_classes {
+	SCHED_AUTO = 0,		/* interactive while on screen, batch otherwise */
+	SCHED_INTERACTIVE,
+	SCHED_BATCH
+};
 
 enum signums {
 	DIV_ZERO = 0,
@@ -11,5 +11,13 @@
 #define SYS_VIDMAP  8
 #define SYS_SET_HANDLER  9
 #define SYS_SIGRETURN  10
+#define SYS_MMAP    11
+#define SYS_GETDENTS 12
+#define SYS_SET_SCHED_CLASS 13
+#define SYS_SBRK 14
+#define SYS_GETPROCS 15
+
+/* the kernel maps its system call stub here in every program */
+#define VSYSCALL_ADDR 0x087FF000
 
 #endif /* ECE391SYSNUM_H */
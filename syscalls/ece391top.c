@@ -0,0 +1,125 @@
+#include <stdint.h>
+
+#include "ece391support.h"
+#include "ece391syscall.h"
+
+#define NUM_RECORDS 64		/* most processes shown */
+#define MAX_PID 256		/* pids run from 0 to MAX_PID - 1 */
+#define DEFAULT_REFRESHES 10	/* screens printed when no count is given */
+#define RTC_FREQ 2		/* two rtc reads per refresh, one second apart */
+#define SBUFSIZE 33
+#define LINE_LEN 81
+
+static struct ece391_procinfo records[NUM_RECORDS];
+static uint32_t last_ticks[MAX_PID];
+
+static const char* class_names[] = {"auto", "inter", "batch"};
+
+/* Copies s into line at *pos, padded with spaces on the right to width. */
+static void
+put_str (uint8_t* line, int32_t* pos, const uint8_t* s, int32_t len, int32_t width)
+{
+    int32_t i;
+
+    for (i = 0; i < len && i < width && '\0' != s[i]; i++)
+        line[(*pos)++] = s[i];
+    for (; i < width; i++)
+        line[(*pos)++] = ' ';
+}
+
+/* Writes value into line at *pos, right aligned in width columns. */
+static void
+put_num (uint8_t* line, int32_t* pos, uint32_t value, int32_t width)
+{
+    uint8_t buf[SBUFSIZE];
+    int32_t len, i;
+
+    ece391_itoa (value, buf, 10);
+    len = ece391_strlen (buf);
+    for (i = len; i < width; i++)
+        line[(*pos)++] = ' ';
+    for (i = 0; i < len; i++)
+        line[(*pos)++] = buf[i];
+}
+
+static void
+print_screen (int32_t cnt)
+{
+    uint8_t line[LINE_LEN];
+    int32_t i, pos;
+    uint32_t ticks;
+
+    ece391_fdputs (1, (uint8_t*)"\n PID PPID TTY CLASS NAME         CPU%   TICKS SYSCALLS  READ KB WRITE KB FAULTS\n");
+    for (i = 0; i < cnt; i++) {
+	/* ticks are 10 ms, so the ticks in the last second are the percentage */
+	ticks = records[i].ticks;
+	if (ticks >= last_ticks[records[i].pid])
+	    ticks -= last_ticks[records[i].pid];
+	last_ticks[records[i].pid] = records[i].ticks;
+	pos = 0;
+	put_num (line, &pos, records[i].pid, 4);
+	if (-1 == records[i].parent)
+	    put_str (line, &pos, (uint8_t*)"    -", 5, 5);
+	else
+	    put_num (line, &pos, records[i].parent, 5);
+	put_num (line, &pos, records[i].terminal + 1, 4);
+	line[pos++] = ' ';
+	put_str (line, &pos, (uint8_t*)class_names[records[i].sched_class], SBUFSIZE, 6);
+	put_str (line, &pos, records[i].name, 32, 11);
+	put_num (line, &pos, ticks, 6);
+	put_num (line, &pos, records[i].ticks, 8);
+	put_num (line, &pos, records[i].syscalls, 9);
+	put_num (line, &pos, records[i].bytes_read >> 10, 9);
+	put_num (line, &pos, records[i].bytes_written >> 10, 9);
+	put_num (line, &pos, records[i].page_faults, 7);
+	line[pos++] = '\n';
+	if (-1 == ece391_write (1, line, pos))
+	    return;
+    }
+}
+
+int main ()
+{
+    uint8_t buf[SBUFSIZE];
+    int32_t refreshes, rtc_fd, cnt, i, freq, garbage;
+
+    /* optional argument: how many times to refresh */
+    refreshes = 0;
+    if (0 == ece391_getargs (buf, SBUFSIZE - 1)) {
+        for (i = 0; buf[i] >= '0' && buf[i] <= '9'; i++)
+	    refreshes = refreshes * 10 + buf[i] - '0';
+    }
+    if (0 == refreshes)
+        refreshes = DEFAULT_REFRESHES;
+
+    if (-1 == (rtc_fd = ece391_open ((uint8_t*)"rtc"))) {
+        ece391_fdputs (1, (uint8_t*)"rtc open failed\n");
+        return 2;
+    }
+    freq = RTC_FREQ;
+    if (-1 == ece391_write (rtc_fd, &freq, sizeof (freq))) {
+        ece391_fdputs (1, (uint8_t*)"rtc write failed\n");
+        return 2;
+    }
+
+    /* start counting from now, not from when each process started */
+    if (-1 == (cnt = ece391_getprocs (records, sizeof (records)))) {
+        ece391_fdputs (1, (uint8_t*)"getprocs failed\n");
+        return 3;
+    }
+    for (i = 0; i < cnt / (int32_t)sizeof (struct ece391_procinfo); i++)
+        last_ticks[records[i].pid] = records[i].ticks;
+
+    while (refreshes-- > 0) {
+	for (i = 0; i < RTC_FREQ; i++)
+	    ece391_read (rtc_fd, &garbage, sizeof (garbage));
+	if (-1 == (cnt = ece391_getprocs (records, sizeof (records)))) {
+	    ece391_fdputs (1, (uint8_t*)"getprocs failed\n");
+	    return 3;
+	}
+	print_screen (cnt / (int32_t)sizeof (struct ece391_procinfo));
+    }
+
+    ece391_close (rtc_fd);
+    return 0;
+}